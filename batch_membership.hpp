@@ -0,0 +1,189 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef BATCH_MEMBERSHIP_HPP
+#define BATCH_MEMBERSHIP_HPP
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include "binary_search.hpp"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+
+
+// Set membership for a whole vector of probe keys, in the shape a
+// column-at-a-time pipeline consumes: bit i of a dense bitset tells whether
+// keys[i] is in the sorted array, and the selection vector lists the
+// positions of the hits in ascending order. The keys are searched
+// monobound_batch_width at a time with the prefetched monobound_batch_search().
+
+// Byte k of compact[mask] is the position of the k-th set bit of mask.
+
+struct batch_membership_compact_table
+{
+	uint64_t compact[256];
+
+	constexpr batch_membership_compact_table() : compact()
+	{
+		for (unsigned mask = 0; mask != 256; ++mask)
+		{
+			unsigned count = 0;
+
+			for (unsigned bit = 0; bit != 8; ++bit)
+			{
+				if (mask & 1U << bit)
+					compact[mask] |= (uint64_t)bit << 8 * count++;
+			}
+		}
+	}
+};
+
+constexpr batch_membership_compact_table batch_membership_table;
+
+inline unsigned batch_membership_popcount(uint64_t word)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return (unsigned)__builtin_popcountll(word);
+#else
+	unsigned count = 0;
+	for (; word != 0; word &= word - 1)
+		++count;
+	return count;
+#endif
+}
+
+// Appends base + position of every set bit of an 8-bit mask to positions,
+// and the matching entries of values to indices when given. All eight
+// lanes are stored, the ones past the hits are overwritten later.
+
+inline size_t batch_membership_compact8(unsigned mask, uint32_t base, const uint32_t* values, uint32_t* positions, uint32_t* indices, size_t hits)
+{
+	const uint64_t lanes = batch_membership_table.compact[mask];
+
+#if defined(__AVX2__)
+	const __m256i order = _mm256_cvtepu8_epi32(_mm_cvtsi64_si128((long long)lanes));
+
+	_mm256_storeu_si256((__m256i*)(positions + hits), _mm256_add_epi32(order, _mm256_set1_epi32((int)base)));
+	if (indices != nullptr)
+		_mm256_storeu_si256((__m256i*)(indices + hits), _mm256_permutevar8x32_epi32(_mm256_loadu_si256((const __m256i*)values), order));
+#else
+	for (unsigned k = 0; k != 8; ++k)
+	{
+		const unsigned lane = lanes >> 8 * k & 7;
+
+		positions[hits + k] = base + lane;
+		if (indices != nullptr)
+			indices[hits + k] = values[lane];
+	}
+#endif
+	return hits + batch_membership_popcount(mask);
+}
+
+// The shared driver. Bits are written for every key, and positions and
+// indices, when given, receive the compacted hits.
+
+template <typename T>
+size_t batch_membership_search(const T* array, size_t size, const T* keys, size_t count, uint64_t* bits, uint32_t* positions, uint32_t* indices)
+{
+	constexpr size_t width = monobound_batch_width;
+	static_assert(width % 8 == 0 && 64 % width == 0, "groups have to fill whole bytes of a bitset word");
+
+	const T* found[width];
+	uint32_t values[width];
+	size_t hits = 0;
+
+	assert(size <= UINT32_MAX && count <= UINT32_MAX);
+
+	for (size_t word = 0; word != (count + 63) / 64; ++word)
+		bits[word] = 0;
+
+	for (size_t base = 0; base < count; base += width)
+	{
+		const size_t group = count - base < width ? count - base : width;
+		uint64_t mask = 0;
+
+		::monobound_batch_search_base(array, array + size, keys + base, keys + base + group, found,
+			[](const T& key, const T& right) { return key < right; },
+			[](const T& key, const T& right) { return key == right; });
+
+		for (size_t j = 0; j != group; ++j)
+		{
+			mask |= (uint64_t)(found[j] != array + size) << j;
+			values[j] = (uint32_t)(found[j] - array);
+		}
+		bits[base / 64] |= mask << base % 64;
+
+		if (positions == nullptr)
+		{
+			hits += batch_membership_popcount(mask);
+			continue;
+		}
+
+		for (size_t chunk = 0; chunk < group; chunk += 8)
+		{
+			const unsigned byte = mask >> chunk & 0xFF;
+
+			// the eight lane stores stay inside count because hits never
+			// exceeds the number of keys before this chunk
+
+			if (base + chunk + 8 <= count)
+				hits = ::batch_membership_compact8(byte, (uint32_t)(base + chunk), values + chunk, positions, indices, hits);
+			else
+			{
+				for (unsigned k = 0; k != batch_membership_popcount(byte); ++k)
+				{
+					const unsigned lane = batch_membership_table.compact[byte] >> 8 * k & 7;
+
+					positions[hits] = (uint32_t)(base + chunk + lane);
+					if (indices != nullptr)
+						indices[hits] = values[chunk + lane];
+					++hits;
+				}
+			}
+		}
+	}
+	return hits;
+}
+
+// Writes the membership of every key to bits, which needs (count + 63) / 64
+// words, and returns the number of keys found.
+
+template <typename T>
+size_t contains_batch(const T* array, size_t size, const T* keys, size_t count, uint64_t* bits)
+{
+	return ::batch_membership_search(array, size, keys, count, bits, nullptr, nullptr);
+}
+
+// As contains_batch(), and also writes the position of every key that was
+// found to positions and the index of its rightmost match in the array to
+// indices. Both need room for count entries. Returns the number of hits.
+
+template <typename T>
+size_t find_batch(const T* array, size_t size, const T* keys, size_t count, uint64_t* bits, uint32_t* positions, uint32_t* indices)
+{
+	return ::batch_membership_search(array, size, keys, count, bits, positions, indices);
+}
+
+#endif
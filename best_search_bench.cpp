@@ -0,0 +1,156 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+*/
+
+/*
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Sweeps the array size for the kernels best_search chooses between on
+	cheap keys: counting_linear_search, monobound_binary_search and
+	monobound_quaternary_search. The time is the best run in nanoseconds per
+	search. best_search_linear_limit() in binary_search.hpp is the largest
+	size at which the counting scan beat both binary kernels; the counting scan
+	is only timed up to 1024 elements.
+
+	Compile using: g++ -O3 -std=c++17 best_search_bench.cpp
+	               g++ -O3 -march=native -std=c++17 best_search_bench.cpp
+
+	Usage: best_search_bench [runs] [repetitions] [seed]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <stdint.h>
+#include <vector>
+#include <plf_nanotimer_c_api.h>
+#include "binary_search.hpp"
+
+static int runs, loop, rnd;
+
+template <typename T, typename Search>
+static double execute(const std::vector<T>& array, const std::vector<T>& keys, long long *hits, Search&& search)
+{
+	nanotimer_data_t timer;
+	double best = 0;
+
+	// read through a volatile so the compiler cannot hoist a cheap search out
+	// of the runs loop; the caller has to use the hits for the same reason
+
+	const T *volatile data = array.data();
+
+	nanotimer(&timer);
+
+	for (int run = runs ; run ; --run)
+	{
+		const T *first = data, *last = first + array.size();
+
+		*hits = 0;
+
+		nanotimer_start(&timer);
+
+		for (const T& key : keys)
+		{
+			*hits += search(first, last, key) != last;
+		}
+
+		double duration = nanotimer_get_elapsed_us(&timer);
+
+		if (best == 0 || duration < best)
+		{
+			best = duration;
+		}
+	}
+	return best * 1000.0 / keys.size();
+}
+
+template <typename T>
+static void sweep(const char *type_name)
+{
+	static const int sizes[] = { 4, 8, 12, 16, 20, 24, 32, 48, 64, 128, 256, 1024, 4096, 16384, 65536, 262144, 1048576, 4194304 };
+
+	printf("| %8s | %10s | %10s | %15s | %10s | %10s |\n", "Type", "Items", "Hits", "counting_linear", "monobound", "quaternary");
+	printf("| %8s | %10s | %10s | %15s | %10s | %10s |\n", "--------", "----------", "----------", "---------------", "----------", "----------");
+
+	for (int max : sizes)
+	{
+		std::vector<T> array(max), keys(loop);
+		long long val = 0, hits = 0, check = 0;
+		char linear[32] = "";
+
+		srand(rnd);
+
+		for (auto& element : array)
+		{
+			element = (T) (val += rand() % 4);
+		}
+
+		for (auto& key : keys)
+		{
+			key = (T) (rand() % (val + 4));
+		}
+
+		if (max <= 1024)
+		{
+			snprintf(linear, sizeof(linear), "%.2f", execute(array, keys, &hits,
+				[](const T* begin, const T* end, const T& key) { return counting_linear_search(begin, end, key); }));
+		}
+
+		double monobound = execute(array, keys, &check,
+			[](const T* begin, const T* end, const T& key) { return monobound_binary_search(begin, end, key); });
+
+		double quaternary = execute(array, keys, &check,
+			[](const T* begin, const T* end, const T& key) { return monobound_quaternary_search(begin, end, key); });
+
+		if (max <= 1024 && hits != check)
+		{
+			fprintf(stderr, "counting_linear_search found %lld keys instead of %lld\n", hits, check);
+		}
+
+		printf("| %8s | %10d | %10lld | %15s | %10.2f | %10.2f |\n", type_name, max, check, linear, monobound, quaternary);
+	}
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	runs = 100;
+	loop = 10000;
+	rnd = time(NULL);
+
+	if (argc > 1)
+		runs = atoi(argv[1]);
+
+	if (argc > 2)
+		loop = atoi(argv[2]);
+
+	if (argc > 3)
+		rnd = atoi(argv[3]);
+
+	printf("Benchmark: runs: %d, repetitions: %d, seed: %d\n\n", runs, loop, rnd);
+
+	sweep<int32_t>("int32");
+	sweep<int64_t>("int64");
+	sweep<double>("double");
+
+	return 0;
+}
@@ -554,6 +554,118 @@ int shar_binary_search(int *array, unsigned int array_size, int key)
 	return (array[i] == key) ? i : -1;
 }
 
+// gallops up from the start, finishes with a monobound search
+
+int exponential_search_forward(int *array, unsigned int array_size, int key)
+{
+	unsigned int bot, top, mid;
+
+	if (array_size == 0)
+	{
+		return -1;
+	}
+	bot = 0;
+	top = 1;
+
+	while (bot + top < array_size)
+	{
+		++checks;
+
+		if (key < array[bot + top])
+		{
+			break;
+		}
+		bot += top;
+		top *= 2;
+	}
+
+	if (top > array_size - bot)
+	{
+		top = array_size - bot;
+	}
+
+	while (top > 1)
+	{
+		mid = top / 2;
+
+		++checks;
+
+		if (key >= array[bot + mid])
+		{
+			bot += mid;
+		}
+		top -= mid;
+	}
+
+	++checks;
+
+	return (key == array[bot]) ? bot : -1;
+}
+
+// gallops down from the end, for keys that are mostly recent
+
+int exponential_search_backward(int *array, unsigned int array_size, int key)
+{
+	unsigned int bot, top, high;
+
+	if (array_size == 0)
+	{
+		return -1;
+	}
+	bot = array_size - 1;
+	top = 1;
+
+	++checks;
+
+	if (key < array[bot])
+	{
+		high = bot;
+
+		while (1)
+		{
+			if (high < top)
+			{
+				bot = 0;
+				top = high;
+
+				break;
+			}
+			bot = high - top;
+
+			++checks;
+
+			if (key >= array[bot])
+			{
+				break;
+			}
+			high = bot;
+			top *= 2;
+		}
+
+		if (top == 0)
+		{
+			return -1;
+		}
+	}
+
+	while (top > 1)
+	{
+		high = top / 2;
+
+		++checks;
+
+		if (key >= array[bot + high])
+		{
+			bot += high;
+		}
+		top -= high;
+	}
+
+	++checks;
+
+	return (key == array[bot]) ? bot : -1;
+}
+
 // benchmark
 
 static int *o_array, *r_array;
@@ -709,6 +821,8 @@ int main(int argc, char **argv)
 	run(monobound_interpolated_search);
 	run(adaptive_binary_search);
 	run(shar_binary_search);
+	run(exponential_search_forward);
+	run(exponential_search_backward);
 
 	// uneven distribution
 
@@ -728,6 +842,8 @@ int main(int argc, char **argv)
 	run(monobound_interpolated_search);
 	run(adaptive_binary_search);
 	run(shar_binary_search);
+	run(exponential_search_forward);
+	run(exponential_search_backward);
 
 	// sequential access, check stability while at it
 
@@ -754,6 +870,29 @@ int main(int argc, char **argv)
 	run(monobound_interpolated_search);
 	run(adaptive_binary_search);
 	run(shar_binary_search);
+	run(exponential_search_forward);
+	run(exponential_search_backward);
+
+	// recency skewed access, most keys are close to the end of the array
+
+	sequential = 0;
+
+	for (cnt = 0 ; cnt < loop ; cnt++)
+	{
+		r_array[cnt] = o_array[max - 1 - rand() % (rand() % (max < 1000 ? max : 1000) + 1)] + rand() % 2;
+	}
+
+	printf("\n\nUneven distribution with %d 32 bit integers, recency skewed access\n\n", max);
+
+	printf("| %30s | %10s | %10s | %10s | %10s | %10s |\n", "Name", "Items", "Hits", "Misses", "Checks", "Time");
+	printf("| %30s | %10s | %10s | %10s | %10s | %10s |\n", "----------", "----------", "----------", "----------", "----------", "----------");
+
+	run(monobound_binary_search);
+	run(monobound_interpolated_search);
+	run(adaptive_binary_search);
+	run(shar_binary_search);
+	run(exponential_search_forward);
+	run(exponential_search_backward);
 
 	free(o_array);
 	free(r_array);
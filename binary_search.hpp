@@ -23,9 +23,22 @@
 #ifndef BINARY_SEARCH_CPP
 #define BINARY_SEARCH_CPP
 #include <type_traits>
+#include <utility>
 #include <iterator>
+#include <memory>
+#include <cstddef>
 #include <cassert>
 
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+#if defined(__GNUC__) || defined(__clang__)
+#define BINARY_SEARCH_PREFETCH(address) __builtin_prefetch(address)
+#else
+#define BINARY_SEARCH_PREFETCH(address) ((void)(address))
+#endif
+
 
 
 template <typename Iterator, typename Equal>
@@ -90,7 +103,7 @@ template <typename Iterator, typename T>
 constexpr Iterator breaking_linear_search(Iterator begin, Iterator end, T&& key)
 {
 	return ::breaking_linear_search_base(begin, end,
-		[&](auto& right) { return key >= right; },
+		[&](auto& right) { return key < right; },
 		[&](auto& right) { return key == right; });
 }
 
@@ -112,7 +125,7 @@ constexpr Iterator standard_binary_search_base(Iterator begin, Iterator end, Les
 	Iterator high = std::prev(end);
 	while (low < high)
 	{
-		Iterator mid = std::next(low, std::distance(low, high) / 2);
+		Iterator mid = std::prev(high, std::distance(low, high) / 2);
 		if (less_than(*mid))
 			high = std::prev(mid);
 		else
@@ -177,7 +190,7 @@ template <typename Iterator, typename T>
 constexpr Iterator boundless_binary_search(Iterator begin, Iterator end, T&& key)
 {
 	return ::boundless_binary_search_base(begin, end,
-		[&](auto& right) { return key >= right; },
+		[&](auto& right) { return key < right; },
 		[&](auto& right) { return key == right; });
 }
 
@@ -192,6 +205,8 @@ constexpr auto boundless_binary_search(Collection&& collection, T&& key)
 template <typename Iterator, typename LessThan, typename Equal>
 constexpr Iterator doubletapped_binary_search_base(Iterator begin, Iterator end, LessThan&& less_than, Equal&& equal_to)
 {
+	if (begin == end)
+		return end;
 	assert(begin < end);
 	auto mid = std::distance(begin, end);
 	decltype(mid) bot = 0;
@@ -225,7 +240,7 @@ template <typename Iterator, typename T>
 constexpr Iterator doubletapped_binary_search(Iterator begin, Iterator end, T&& key)
 {
 	return ::doubletapped_binary_search_base(begin, end,
-		[&](auto& right) { return key >= right; },
+		[&](auto& right) { return key < right; },
 		[&](auto& right) { return key == right; });
 }
 
@@ -250,7 +265,7 @@ constexpr Iterator monobound_binary_search_base(Iterator begin, Iterator end, Le
 	while (high > second)
 	{
 		const auto k = std::distance(begin, high) / 2;
-		if (!less_than(*std::next(begin, k)))
+		if (!less_than(*std::next(low, k)))
 			low += k;
 		high -= k;
 	}
@@ -282,6 +297,112 @@ constexpr auto monobound_binary_search(Collection&& collection, T&& key)
 
 
 
+// Searches monobound_batch_width keys in lockstep. Since every search shares the
+// same top sequence the probes of one round are independent of each other, so
+// their cache misses overlap, and the next probe is prefetched as soon as it is known.
+
+constexpr size_t monobound_batch_width = 16;
+
+template <typename Iterator, typename KeyIterator, typename OutputIterator, typename LessThan, typename Equal>
+OutputIterator monobound_batch_search_base(Iterator begin, Iterator end, KeyIterator first, KeyIterator last, OutputIterator out, LessThan&& less_than, Equal&& equal_to)
+{
+	assert(begin <= end);
+	const auto size = std::distance(begin, end);
+
+	while (first != last)
+	{
+		size_t count = (size_t)std::distance(first, last);
+		if (count > monobound_batch_width)
+			count = monobound_batch_width;
+
+		if (size == 0)
+		{
+			for (size_t j = 0; j != count; ++j)
+				*out++ = end;
+			std::advance(first, count);
+			continue;
+		}
+
+		decltype(std::distance(begin, end)) bot[monobound_batch_width] = {};
+		auto top = size;
+
+		while (top > 1)
+		{
+			const auto mid = top / 2;
+			for (size_t j = 0; j != count; ++j)
+				if (!less_than(*std::next(first, j), *std::next(begin, bot[j] + mid)))
+					bot[j] += mid;
+			top -= mid;
+			for (size_t j = 0; j != count; ++j)
+				BINARY_SEARCH_PREFETCH(std::addressof(*std::next(begin, bot[j] + top / 2)));
+		}
+
+		for (size_t j = 0; j != count; ++j)
+		{
+			Iterator target = std::next(begin, bot[j]);
+			*out++ = equal_to(*std::next(first, j), *target) ? target : end;
+		}
+		std::advance(first, count);
+	}
+
+	return out;
+}
+
+template <typename Iterator, typename KeyIterator, typename OutputIterator, typename LessThan, typename Equal>
+OutputIterator monobound_batch_search(Iterator begin, Iterator end, KeyIterator first, KeyIterator last, OutputIterator out, LessThan&& less_than, Equal&& equal_to)
+{
+	return ::monobound_batch_search_base(begin, end, first, last, out,
+		std::forward<LessThan>(less_than), std::forward<Equal>(equal_to));
+}
+
+template <typename Iterator, typename KeyIterator, typename OutputIterator>
+OutputIterator monobound_batch_search(Iterator begin, Iterator end, KeyIterator first, KeyIterator last, OutputIterator out)
+{
+	return ::monobound_batch_search_base(begin, end, first, last, out,
+		[](auto& key, auto& right) { return key < right; },
+		[](auto& key, auto& right) { return key == right; });
+}
+
+template <typename Collection, typename Keys, typename OutputIterator>
+auto monobound_batch_search(Collection&& collection, Keys&& keys, OutputIterator out)
+{
+	return ::monobound_batch_search(collection.begin(), collection.end(), keys.begin(), keys.end(), out);
+}
+
+
+
+// The first element for which the predicate is false, like std::partition_point,
+// using the monobound loop. lower and upper bounds are partition points of
+// [&](auto& x) { return x < key; } and [&](auto& x) { return !(key < x); }.
+
+template <typename Iterator, typename Predicate>
+constexpr Iterator monobound_partition_point(Iterator begin, Iterator end, Predicate&& predicate)
+{
+	if (begin == end)
+		return end;
+	assert(begin < end);
+	auto top = std::distance(begin, end);
+	decltype(top) bot = 0;
+
+	while (top > 1)
+	{
+		auto mid = top / 2;
+		if (predicate(*std::next(begin, bot + mid)))
+			bot += mid;
+		top -= mid;
+	}
+
+	return std::next(begin, bot + (predicate(*std::next(begin, bot)) ? 1 : 0));
+}
+
+template <typename Collection, typename Predicate>
+constexpr auto monobound_partition_point(Collection&& collection, Predicate&& predicate)
+{
+	return ::monobound_partition_point(collection.begin(), collection.end(), std::forward<Predicate>(predicate));
+}
+
+
+
 template <typename Iterator, typename LessThan, typename Equal>
 constexpr Iterator tripletapped_binary_search_base(Iterator begin, Iterator end, LessThan&& less_than, Equal&& equal_to)
 {
@@ -292,7 +413,6 @@ constexpr Iterator tripletapped_binary_search_base(Iterator begin, Iterator end,
 
 	auto top = std::distance(begin, end);
 	decltype(top) bot = 0;
-	decltype(top) mid = 0;
 
 	while (top > 3)
 	{
@@ -302,7 +422,7 @@ constexpr Iterator tripletapped_binary_search_base(Iterator begin, Iterator end,
 		top -= mid;
 	}
 
-	while (mid--)
+	while (top--)
 	{
 		Iterator target = std::next(begin, bot + top);
 		if (equal_to(*target))
@@ -336,6 +456,170 @@ constexpr auto tripletapped_binary_search(Collection&& collection, T&& key)
 
 
 
+// The doubletapped and tripletapped searches generalized: the monobound loop
+// stops once Taps elements or fewer are left, and an equality tail checks those
+// from the right. On pointers to 32 and 64 bit integers a tail of at least one
+// vector width is finished with vector compares and a movemask, loading whole
+// vectors that end at the top of the window; everything left of the window is
+// smaller than the key unless it belongs to a run of matches that reaches into
+// the window, so the highest set bit is still the rightmost match.
+
+template <size_t Taps, typename Iterator, typename LessThan, typename Equal>
+constexpr Iterator tapped_binary_search_base(Iterator begin, Iterator end, LessThan&& less_than, Equal&& equal_to)
+{
+	static_assert(Taps >= 2 && Taps <= 32, "the tail width has to be between 2 and 32");
+
+	if (begin == end)
+		return end;
+	assert(begin < end);
+
+	auto top = std::distance(begin, end);
+	decltype(top) bot = 0;
+
+	while (top > (decltype(top))Taps)
+	{
+		auto mid = top / 2;
+		if (!less_than(*std::next(begin, bot + mid)))
+			bot += mid;
+		top -= mid;
+	}
+
+	while (top--)
+	{
+		Iterator target = std::next(begin, bot + top);
+		if (equal_to(*target))
+			return target;
+	}
+
+	return end;
+}
+
+template <typename T>
+constexpr size_t tapped_binary_search_lanes()
+{
+#if defined(__AVX2__)
+	return std::is_integral<T>::value && (sizeof(T) == 4 || sizeof(T) == 8) ? 32 / sizeof(T) : 0;
+#elif defined(__SSE2__) || defined(_M_X64)
+	return std::is_integral<T>::value && sizeof(T) == 4 ? 4 : 0;
+#else
+	return 0;
+#endif
+}
+
+#if defined(__AVX2__)
+template <typename T>
+unsigned tapped_binary_search_mask(const T* lane, T key, std::integral_constant<size_t, 4>)
+{
+	const __m256i v = _mm256_loadu_si256((const __m256i*)lane);
+	return (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpeq_epi32(v, _mm256_set1_epi32((int32_t)key))));
+}
+
+template <typename T>
+unsigned tapped_binary_search_mask(const T* lane, T key, std::integral_constant<size_t, 8>)
+{
+	const __m256i v = _mm256_loadu_si256((const __m256i*)lane);
+	return (unsigned)_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpeq_epi64(v, _mm256_set1_epi64x((int64_t)key))));
+}
+#endif
+
+// The index of the rightmost element equal to key in array[bot .. bot + top),
+// or -1, where top <= Taps and the array holds at least one vector.
+
+template <typename T>
+ptrdiff_t tapped_binary_search_tail(const T* array, ptrdiff_t bot, ptrdiff_t top, T key)
+{
+	constexpr ptrdiff_t lanes = (ptrdiff_t)tapped_binary_search_lanes<T>();
+
+	for (ptrdiff_t last = bot + top; last > bot; last -= lanes)
+	{
+		const ptrdiff_t first = last >= lanes ? last - lanes : 0;
+		unsigned mask;
+
+#if defined(__AVX2__)
+		mask = ::tapped_binary_search_mask(array + first, key, std::integral_constant<size_t, sizeof(T)>());
+#elif defined(__SSE2__) || defined(_M_X64)
+		mask = (unsigned)_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)(array + first)), _mm_set1_epi32((int32_t)key))));
+#else
+		mask = 0;
+#endif
+		if (mask != 0)
+		{
+			unsigned lane = lanes - 1;
+			while (!(mask >> lane & 1))
+				--lane;
+			return first + lane;
+		}
+
+		if (first == 0)
+			break;
+	}
+	return -1;
+}
+
+template <size_t Taps, typename Iterator, typename T, typename LessThan, typename Equal>
+constexpr Iterator tapped_binary_search(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to)
+{
+	return ::tapped_binary_search_base<Taps>(begin, end,
+		[&](auto& right) { return less_than(key, right); },
+		[&](auto& right) { return equal_to(key, right); });
+}
+
+// Internal to tapped_binary_search, which only takes the std::true_type path
+// for a pointer range whose element type matches the key and vectorizes.
+
+template <size_t Taps, typename Iterator, typename T>
+constexpr Iterator tapped_binary_search_dispatch(Iterator begin, Iterator end, T&& key, std::false_type)
+{
+	return ::tapped_binary_search_base<Taps>(begin, end,
+		[&](auto& right) { return key < right; },
+		[&](auto& right) { return key == right; });
+}
+
+template <size_t Taps, typename Iterator, typename T>
+constexpr Iterator tapped_binary_search_dispatch(Iterator begin, Iterator end, T&& key, std::true_type)
+{
+	constexpr size_t lanes = tapped_binary_search_lanes<std::decay_t<T>>();
+	const auto size = end - begin;
+
+	if (size < (decltype(size))lanes)
+		return ::tapped_binary_search_dispatch<Taps>(begin, end, std::forward<T>(key), std::false_type());
+
+	auto top = size;
+	decltype(top) bot = 0;
+
+	while (top > (decltype(top))Taps)
+	{
+		auto mid = top / 2;
+		if (!(key < begin[bot + mid]))
+			bot += mid;
+		top -= mid;
+	}
+
+	const ptrdiff_t found = ::tapped_binary_search_tail(&*begin, bot, top, key);
+	return found < 0 ? end : begin + found;
+}
+
+template <size_t Taps, typename Iterator, typename T>
+constexpr Iterator tapped_binary_search(Iterator begin, Iterator end, T&& key)
+{
+	using value_type = typename std::iterator_traits<Iterator>::value_type;
+	constexpr size_t lanes = tapped_binary_search_lanes<value_type>();
+
+	// the vector compare works in the element type, so a key of any other
+	// type takes the scalar path, which compares in the promoted type
+
+	return ::tapped_binary_search_dispatch<Taps>(begin, end, std::forward<T>(key),
+		std::integral_constant<bool, std::is_pointer<Iterator>::value && std::is_same<std::decay_t<T>, value_type>::value && lanes != 0 && Taps >= lanes>());
+}
+
+template <size_t Taps, typename Collection, typename T>
+constexpr auto tapped_binary_search(Collection&& collection, T&& key)
+{
+	return ::tapped_binary_search<Taps>(collection.begin(), collection.end(), std::forward<T>(key));
+}
+
+
+
 template <typename Iterator, typename LessThan, typename Equal>
 constexpr Iterator monobound_quaternary_search_base(Iterator begin, Iterator end, LessThan&& less_than, Equal&& equal_to)
 {
@@ -406,6 +690,32 @@ constexpr auto monobound_quaternary_search(Collection&& collection, T&& key)
 
 
 
+// The difference high - low as a double. Integer keys are subtracted as
+// unsigned, so keys far apart, such as the two ends of a 64-bit key range,
+// do not overflow.
+
+template <typename T, typename U>
+constexpr double interpolation_search_distance(const T& high, const U& low, std::true_type)
+{
+	using common_type = std::common_type_t<T, U>;
+	using unsigned_type = std::make_unsigned_t<common_type>;
+	const unsigned_type a = (unsigned_type)(common_type)high, b = (unsigned_type)(common_type)low;
+
+	return (common_type)high < (common_type)low ? -(double)(unsigned_type)(b - a) : (double)(unsigned_type)(a - b);
+}
+
+template <typename T, typename U>
+constexpr double interpolation_search_distance(const T& high, const U& low, std::false_type)
+{
+	return (double)high - (double)low;
+}
+
+template <typename T, typename U>
+constexpr double interpolation_search_distance(const T& high, const U& low)
+{
+	return ::interpolation_search_distance(high, low, std::is_integral<std::common_type_t<T, U>>());
+}
+
 template <typename Iterator, typename T, typename LessThan, typename Equal>
 constexpr Iterator monobound_interpolated_search_base(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to)
 {
@@ -422,14 +732,14 @@ constexpr Iterator monobound_interpolated_search_base(Iterator begin, Iterator e
 	auto max = std::next(begin, bot);
 
 	if (!less_than(*max))
-		return equal_to(max) ? max : end;
+		return equal_to(*max) ? max : end;
 
 	auto min = begin;
 	using real_type = std::conditional_t<(sizeof(bot) > 4), double, float>;
-	bot *= (real_type)(key - *min) / (*max - *min);
-	auto top = 64;
+	bot *= (real_type)(::interpolation_search_distance(key, *min) / ::interpolation_search_distance(*max, *min));
+	decltype(bot) top = 64;
 
-	if (!less_than(std::next(begin, bot)))
+	if (!less_than(*std::next(begin, bot)))
 	{
 		while (true)
 		{
@@ -458,7 +768,7 @@ constexpr Iterator monobound_interpolated_search_base(Iterator begin, Iterator e
 				break;
 			}
 			bot -= top;
-			if (less_than(*std::next(begin, bot)))
+			if (!less_than(*std::next(begin, bot)))
 				break;
 			top *= 2;
 		}
@@ -512,8 +822,8 @@ struct adaptive_binary_search_state
 	size_t i, balance;
 };
 
-template <typename Iterator, typename T, typename LessThan, typename Equal>
-constexpr Iterator adaptive_binary_search_base(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to, adaptive_binary_search_state& state)
+template <typename Iterator, typename LessThan, typename Equal>
+constexpr Iterator adaptive_binary_search_base(Iterator begin, Iterator end, LessThan&& less_than, Equal&& equal_to, adaptive_binary_search_state& state)
 {
 	if (begin == end)
 		return end;
@@ -521,7 +831,7 @@ constexpr Iterator adaptive_binary_search_base(Iterator begin, Iterator end, T&&
 	auto size = std::distance(begin, end);
 	decltype(size) bot, top;
 
-	if (state.balance < 32 && size > 64)
+	if (state.balance < 32 && size > 64 && state.i < (size_t)size)
 	{
 		bot = state.i;
 		top = 32;
@@ -564,9 +874,20 @@ constexpr Iterator adaptive_binary_search_base(Iterator begin, Iterator end, T&&
 	else
 	{
 		bot = 0;
-		top = array_size;
+		top = size;
+	}
+
+	while (top > 3)
+	{
+		auto mid = top / 2;
+		if (!less_than(*std::next(begin, bot + mid)))
+			bot += mid;
+		top -= mid;
 	}
 
+	state.balance = state.i > (size_t)bot ? state.i - bot : bot - state.i;
+	state.i = bot;
+
 	while (top != 0)
 		if (equal_to(*std::next(begin, bot + --top)))
 			return std::next(begin, bot + top);
@@ -577,7 +898,7 @@ constexpr Iterator adaptive_binary_search_base(Iterator begin, Iterator end, T&&
 template <typename Iterator, typename T, typename LessThan, typename Equal>
 constexpr Iterator adaptive_binary_search(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to, adaptive_binary_search_state& state)
 {
-	return ::adaptive_binary_search_base(begin, end, key,
+	return ::adaptive_binary_search_base(begin, end,
 		[&](auto& right) { return less_than(key, right); },
 		[&](auto& right) { return equal_to(key, right); },
 		state);
@@ -586,7 +907,7 @@ constexpr Iterator adaptive_binary_search(Iterator begin, Iterator end, T&& key,
 template <typename Iterator, typename T>
 constexpr Iterator adaptive_binary_search(Iterator begin, Iterator end, T&& key, adaptive_binary_search_state& state)
 {
-	return ::adaptive_binary_search_base(begin, end, key,
+	return ::adaptive_binary_search_base(begin, end,
 		[&](auto& right) { return key < right; },
 		[&](auto& right) { return key == right; },
 		state);
@@ -598,4 +919,684 @@ constexpr auto adaptive_binary_search(Collection&& collection, T&& key, adaptive
 	return ::adaptive_binary_search(collection.begin(), collection.end(), std::forward<T>(key), state);
 }
 
+
+
+// Gallops from origin towards the key with steps of 1, 2, 4 and so on until
+// the key is bracketed, then finishes with a monobound search on the bracket.
+// The cost is logarithmic in the distance between origin and the match
+// instead of in the size of the array. origin may be end, which starts at the
+// last element.
+
+template <typename Iterator, typename LessThan, typename Equal>
+constexpr Iterator exponential_search_from_base(Iterator begin, Iterator end, Iterator origin, LessThan&& less_than, Equal&& equal_to)
+{
+	if (begin == end)
+		return end;
+	assert(begin <= origin && origin <= end);
+	if (origin == end)
+		origin = std::prev(end);
+	const auto size = std::distance(begin, end);
+	auto bot = std::distance(begin, origin);
+	decltype(bot) top = 1;
+
+	if (!less_than(*origin))
+	{
+		while (bot + top < size && !less_than(*std::next(begin, bot + top)))
+		{
+			bot += top;
+			top *= 2;
+		}
+		if (top > size - bot)
+			top = size - bot;
+	}
+	else
+	{
+		auto high = bot;
+
+		while (true)
+		{
+			if (high < top)
+			{
+				bot = 0;
+				top = high;
+				break;
+			}
+			bot = high - top;
+			if (!less_than(*std::next(begin, bot)))
+				break;
+			high = bot;
+			top *= 2;
+		}
+		if (top == 0)
+			return end;
+	}
+
+	while (top > 1)
+	{
+		const auto mid = top / 2;
+		if (!less_than(*std::next(begin, bot + mid)))
+			bot += mid;
+		top -= mid;
+	}
+
+	const Iterator target = std::next(begin, bot);
+	return equal_to(*target) ? target : end;
+}
+
+template <typename Iterator, typename T, typename LessThan, typename Equal>
+constexpr Iterator exponential_search_from(Iterator begin, Iterator end, Iterator origin, T&& key, LessThan&& less_than, Equal&& equal_to)
+{
+	return ::exponential_search_from_base(begin, end, origin,
+		[&](auto& right) { return less_than(key, right); },
+		[&](auto& right) { return equal_to(key, right); });
+}
+
+template <typename Iterator, typename T>
+constexpr Iterator exponential_search_from(Iterator begin, Iterator end, Iterator origin, T&& key)
+{
+	return ::exponential_search_from_base(begin, end, origin,
+		[&](auto& right) { return key < right; },
+		[&](auto& right) { return key == right; });
+}
+
+template <typename Collection, typename Iterator, typename T>
+constexpr auto exponential_search_from(Collection&& collection, Iterator origin, T&& key)
+{
+	return ::exponential_search_from(collection.begin(), collection.end(), origin, std::forward<T>(key));
+}
+
+// Gallops up from the first element, for keys that are usually near the start.
+
+template <typename Iterator, typename LessThan, typename Equal>
+constexpr Iterator exponential_search_forward_base(Iterator begin, Iterator end, LessThan&& less_than, Equal&& equal_to)
+{
+	return ::exponential_search_from_base(begin, end, begin, less_than, equal_to);
+}
+
+template <typename Iterator, typename T, typename LessThan, typename Equal>
+constexpr Iterator exponential_search_forward(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to)
+{
+	return ::exponential_search_from(begin, end, begin, key, less_than, equal_to);
+}
+
+template <typename Iterator, typename T>
+constexpr Iterator exponential_search_forward(Iterator begin, Iterator end, T&& key)
+{
+	return ::exponential_search_from(begin, end, begin, key);
+}
+
+template <typename Collection, typename T>
+constexpr auto exponential_search_forward(Collection&& collection, T&& key)
+{
+	return ::exponential_search_forward(collection.begin(), collection.end(), std::forward<T>(key));
+}
+
+// Gallops down from the last element, for append heavy arrays where lookups
+// mostly ask for recent keys.
+
+template <typename Iterator, typename LessThan, typename Equal>
+constexpr Iterator exponential_search_backward_base(Iterator begin, Iterator end, LessThan&& less_than, Equal&& equal_to)
+{
+	return ::exponential_search_from_base(begin, end, end, less_than, equal_to);
+}
+
+template <typename Iterator, typename T, typename LessThan, typename Equal>
+constexpr Iterator exponential_search_backward(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to)
+{
+	return ::exponential_search_from(begin, end, end, key, less_than, equal_to);
+}
+
+template <typename Iterator, typename T>
+constexpr Iterator exponential_search_backward(Iterator begin, Iterator end, T&& key)
+{
+	return ::exponential_search_from(begin, end, end, key);
+}
+
+template <typename Collection, typename T>
+constexpr auto exponential_search_backward(Collection&& collection, T&& key)
+{
+	return ::exponential_search_backward(collection.begin(), collection.end(), std::forward<T>(key));
+}
+
+
+
+// Once an interpolation search estimates a position within this many
+// elements of its last probe, or its window is this small, it finishes with
+// an exponential search from the estimate. Close to the key that visits the
+// neighbouring elements one by one, as a sequential scan would, but it stays
+// logarithmic when the estimate was off.
+
+constexpr size_t interpolation_search_guard = 8;
+
+// Finishes an interpolation search whose window bot..top holds the key,
+// with element bot <= key < element top.
+
+template <typename Iterator, typename Index, typename LessThan, typename Equal>
+constexpr Iterator interpolation_search_finish(Iterator begin, Iterator end, Index bot, Index top, double estimate, LessThan&& less_than, Equal&& equal_to)
+{
+	const Index at = estimate > bot && estimate < top ? (Index)estimate : bot;
+	const Iterator first = std::next(begin, bot), last = std::next(begin, top);
+	const Iterator found = ::exponential_search_from_base(first, last, std::next(begin, at), less_than, equal_to);
+
+	return found == last ? end : found;
+}
+
+// Interpolation-sequential search. The first probe interpolates between the
+// ends of the array as monobound_interpolated_search() does, and the slope of
+// that line is reused to correct every later estimate by the distance
+// between the key and the element just probed, which costs no division.
+// Probes narrow the window until the estimate stays near the last probe,
+// then the neighbourhood is searched. When a probe removes less than a
+// quarter of the window the next one bisects, which bounds the number of
+// probes on distributions that interpolate badly.
+
+template <typename Iterator, typename T, typename LessThan, typename Equal>
+constexpr Iterator interpolation_sequential_search_base(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to)
+{
+	if (begin == end)
+		return end;
+	assert(begin < end);
+
+	if (less_than(*begin))
+		return end;
+
+	decltype(std::distance(begin, end)) bot = 0, top = std::distance(begin, end) - 1;
+
+	if (!less_than(*std::next(begin, top)))
+		return equal_to(*std::next(begin, top)) ? std::next(begin, top) : end;
+
+	const double slope = top / ::interpolation_search_distance(*std::next(begin, top), *begin);
+	double estimate = ::interpolation_search_distance(key, *begin) * slope;
+	bool bisect = false;
+
+	while (true)
+	{
+		const auto span = top - bot;
+
+		if ((size_t)span <= interpolation_search_guard)
+			return ::interpolation_search_finish(begin, end, bot, top, estimate, less_than, equal_to);
+
+		auto probe = bot + span / 2;
+
+		if (!bisect && estimate > bot && estimate < top)
+			probe = (decltype(span))estimate > bot ? (decltype(span))estimate : bot + 1;
+
+		const auto& right = *std::next(begin, probe);
+
+		if (less_than(right))
+			top = probe;
+		else
+			bot = probe;
+
+		estimate = probe + ::interpolation_search_distance(key, right) * slope;
+
+		if (estimate > probe - (double)interpolation_search_guard && estimate < probe + (double)interpolation_search_guard)
+			return ::interpolation_search_finish(begin, end, bot, top, estimate, less_than, equal_to);
+
+		bisect = (top - bot) * 4 > span * 3;
+	}
+}
+
+template <typename Iterator, typename T, typename LessThan, typename Equal>
+constexpr Iterator interpolation_sequential_search(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to)
+{
+	return ::interpolation_sequential_search_base(begin, end, key,
+		[&](auto& right) { return less_than(key, right); },
+		[&](auto& right) { return equal_to(key, right); });
+}
+
+template <typename Iterator, typename T>
+constexpr Iterator interpolation_sequential_search(Iterator begin, Iterator end, T&& key)
+{
+	return ::interpolation_sequential_search_base(begin, end, key,
+		[&](auto& right) { return key < right; },
+		[&](auto& right) { return key == right; });
+}
+
+template <typename Collection, typename T>
+constexpr auto interpolation_sequential_search(Collection&& collection, T&& key)
+{
+	return ::interpolation_sequential_search(collection.begin(), collection.end(), std::forward<T>(key));
+}
+
+// Three-point interpolation search. After a first linear estimate, every
+// probe is followed by fitting a hyperbola through the probe and both ends of
+// the window it split, and the next estimate is where that curve reaches the
+// key. A hyperbola is monotone between its poles and follows curvature that
+// a straight line misses, so smooth non-linear distributions converge in a
+// few probes. Estimates outside the window fall back to a bisection, and the
+// search finishes as interpolation_sequential_search() does.
+
+template <typename Iterator, typename T, typename LessThan, typename Equal>
+constexpr Iterator three_point_interpolation_search_base(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to)
+{
+	if (begin == end)
+		return end;
+	assert(begin < end);
+
+	if (less_than(*begin))
+		return end;
+
+	decltype(std::distance(begin, end)) bot = 0, top = std::distance(begin, end) - 1;
+
+	if (!less_than(*std::next(begin, top)))
+		return equal_to(*std::next(begin, top)) ? std::next(begin, top) : end;
+
+	// the key minus the element at bot and at top
+
+	double low = ::interpolation_search_distance(key, *begin);
+	double high = ::interpolation_search_distance(key, *std::next(begin, top));
+	double estimate = top * (low / (low - high));
+	bool bisect = false;
+
+	while (true)
+	{
+		const auto span = top - bot;
+
+		if ((size_t)span <= interpolation_search_guard)
+			return ::interpolation_search_finish(begin, end, bot, top, estimate, less_than, equal_to);
+
+		auto probe = bot + span / 2;
+
+		if (!bisect && estimate > bot && estimate < top)
+			probe = (decltype(span))estimate > bot ? (decltype(span))estimate : bot + 1;
+
+		const auto& right = *std::next(begin, probe);
+		const double middle = ::interpolation_search_distance(key, right);
+
+		// the hyperbola through (bot, low), (probe, middle) and (top, high),
+		// solved for the key relative to probe
+
+		const double before = (double)(bot - probe), after = (double)(top - probe);
+		const double divisor = after * high * (low - middle) - before * low * (high - middle);
+
+		estimate = divisor != 0 ? probe + before * after * middle * (low - high) / divisor : (double)probe;
+
+		if (less_than(right))
+		{
+			top = probe;
+			high = middle;
+		}
+		else
+		{
+			bot = probe;
+			low = middle;
+		}
+
+		if (estimate > probe - (double)interpolation_search_guard && estimate < probe + (double)interpolation_search_guard)
+			return ::interpolation_search_finish(begin, end, bot, top, estimate, less_than, equal_to);
+
+		bisect = (top - bot) * 4 > span * 3;
+	}
+}
+
+template <typename Iterator, typename T, typename LessThan, typename Equal>
+constexpr Iterator three_point_interpolation_search(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to)
+{
+	return ::three_point_interpolation_search_base(begin, end, key,
+		[&](auto& right) { return less_than(key, right); },
+		[&](auto& right) { return equal_to(key, right); });
+}
+
+template <typename Iterator, typename T>
+constexpr Iterator three_point_interpolation_search(Iterator begin, Iterator end, T&& key)
+{
+	return ::three_point_interpolation_search_base(begin, end, key,
+		[&](auto& right) { return key < right; },
+		[&](auto& right) { return key == right; });
+}
+
+template <typename Collection, typename T>
+constexpr auto three_point_interpolation_search(Collection&& collection, T&& key)
+{
+	return ::three_point_interpolation_search(collection.begin(), collection.end(), std::forward<T>(key));
+}
+
+
+
+// Shar's search probes the largest power of two below size first, which either
+// keeps the search at the start or moves it so that the remaining size - p
+// elements are covered by a power of two. Every later step halves p with a
+// conditional add.
+
+template <typename Size>
+constexpr unsigned shar_binary_search_log2(Size size)
+{
+#if defined(__GNUC__) || defined(__clang__)
+	return 63 - (unsigned)__builtin_clzll((unsigned long long)size);
+#else
+	unsigned log = 0;
+	while (size >>= 1)
+		++log;
+	return log;
+#endif
+}
+
+template <typename Iterator, typename LessThan, typename Equal>
+constexpr Iterator shar_binary_search_base(Iterator begin, Iterator end, LessThan&& less_than, Equal&& equal_to)
+{
+	if (begin == end)
+		return end;
+	assert(begin < end);
+	const auto size = std::distance(begin, end);
+	decltype(std::distance(begin, end)) i = 0;
+
+	if (size > 1)
+	{
+		auto p = (decltype(size))1 << shar_binary_search_log2(size - 1);
+		i = less_than(*std::next(begin, p)) ? 0 : size - p;
+
+		while (p >>= 1)
+			i += less_than(*std::next(begin, i + p)) ? 0 : p;
+	}
+
+	return equal_to(*std::next(begin, i)) ? std::next(begin, i) : end;
+}
+
+template <typename Iterator, typename T, typename LessThan, typename Equal>
+constexpr Iterator shar_binary_search(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to)
+{
+	return ::shar_binary_search_base(begin, end,
+		[&](auto& right) { return less_than(key, right); },
+		[&](auto& right) { return equal_to(key, right); });
+}
+
+template <typename Iterator, typename T>
+constexpr Iterator shar_binary_search(Iterator begin, Iterator end, T&& key)
+{
+	return ::shar_binary_search_base(begin, end,
+		[&](auto& right) { return key < right; },
+		[&](auto& right) { return key == right; });
+}
+
+template <typename Collection, typename T>
+constexpr auto shar_binary_search(Collection&& collection, T&& key)
+{
+	return ::shar_binary_search(collection.begin(), collection.end(), std::forward<T>(key));
+}
+
+// The same search without a loop: the number of halving steps is log2 of the
+// first probe, and a switch on it jumps into a ladder of conditional adds that
+// falls through to the end, like Duff's device. Sizes up to 2^32 run as
+// straight-line code, larger ones loop until they reach the ladder.
+
+#define BINARY_SEARCH_SHAR_STEP(n) \
+	case n + 1: \
+		i += less_than(*std::next(begin, i + ((decltype(size))1 << n))) ? 0 : (decltype(size))1 << n; \
+		[[fallthrough]];
+
+template <typename Iterator, typename LessThan, typename Equal>
+constexpr Iterator shar_unrolled_binary_search_base(Iterator begin, Iterator end, LessThan&& less_than, Equal&& equal_to)
+{
+	if (begin == end)
+		return end;
+	assert(begin < end);
+	const auto size = std::distance(begin, end);
+	decltype(std::distance(begin, end)) i = 0;
+
+	if (size > 1)
+	{
+		unsigned log = shar_binary_search_log2(size - 1);
+		const auto p = (decltype(size))1 << log;
+		i = less_than(*std::next(begin, p)) ? 0 : size - p;
+
+		for (; log > 32; --log)
+			i += less_than(*std::next(begin, i + ((decltype(size))1 << (log - 1)))) ? 0 : (decltype(size))1 << (log - 1);
+
+		switch (log)
+		{
+		BINARY_SEARCH_SHAR_STEP(31)
+		BINARY_SEARCH_SHAR_STEP(30)
+		BINARY_SEARCH_SHAR_STEP(29)
+		BINARY_SEARCH_SHAR_STEP(28)
+		BINARY_SEARCH_SHAR_STEP(27)
+		BINARY_SEARCH_SHAR_STEP(26)
+		BINARY_SEARCH_SHAR_STEP(25)
+		BINARY_SEARCH_SHAR_STEP(24)
+		BINARY_SEARCH_SHAR_STEP(23)
+		BINARY_SEARCH_SHAR_STEP(22)
+		BINARY_SEARCH_SHAR_STEP(21)
+		BINARY_SEARCH_SHAR_STEP(20)
+		BINARY_SEARCH_SHAR_STEP(19)
+		BINARY_SEARCH_SHAR_STEP(18)
+		BINARY_SEARCH_SHAR_STEP(17)
+		BINARY_SEARCH_SHAR_STEP(16)
+		BINARY_SEARCH_SHAR_STEP(15)
+		BINARY_SEARCH_SHAR_STEP(14)
+		BINARY_SEARCH_SHAR_STEP(13)
+		BINARY_SEARCH_SHAR_STEP(12)
+		BINARY_SEARCH_SHAR_STEP(11)
+		BINARY_SEARCH_SHAR_STEP(10)
+		BINARY_SEARCH_SHAR_STEP(9)
+		BINARY_SEARCH_SHAR_STEP(8)
+		BINARY_SEARCH_SHAR_STEP(7)
+		BINARY_SEARCH_SHAR_STEP(6)
+		BINARY_SEARCH_SHAR_STEP(5)
+		BINARY_SEARCH_SHAR_STEP(4)
+		BINARY_SEARCH_SHAR_STEP(3)
+		BINARY_SEARCH_SHAR_STEP(2)
+		BINARY_SEARCH_SHAR_STEP(1)
+		BINARY_SEARCH_SHAR_STEP(0)
+		case 0:
+			break;
+		}
+	}
+
+	return equal_to(*std::next(begin, i)) ? std::next(begin, i) : end;
+}
+
+#undef BINARY_SEARCH_SHAR_STEP
+
+template <typename Iterator, typename T, typename LessThan, typename Equal>
+constexpr Iterator shar_unrolled_binary_search(Iterator begin, Iterator end, T&& key, LessThan&& less_than, Equal&& equal_to)
+{
+	return ::shar_unrolled_binary_search_base(begin, end,
+		[&](auto& right) { return less_than(key, right); },
+		[&](auto& right) { return equal_to(key, right); });
+}
+
+template <typename Iterator, typename T>
+constexpr Iterator shar_unrolled_binary_search(Iterator begin, Iterator end, T&& key)
+{
+	return ::shar_unrolled_binary_search_base(begin, end,
+		[&](auto& right) { return key < right; },
+		[&](auto& right) { return key == right; });
+}
+
+template <typename Collection, typename T>
+constexpr auto shar_unrolled_binary_search(Collection&& collection, T&& key)
+{
+	return ::shar_unrolled_binary_search(collection.begin(), collection.end(), std::forward<T>(key));
+}
+
+
+
+// Counts the elements that are not greater than the key instead of searching.
+// The loop has no early exit and no data dependent branch, so for arithmetic
+// keys the compiler turns it into a vector compare and add, which beats every
+// binary search on a handful of elements.
+
+template <typename Iterator, typename LessThan, typename Equal>
+constexpr Iterator counting_linear_search_base(Iterator begin, Iterator end, LessThan&& less_than, Equal&& equal_to)
+{
+	size_t count = 0;
+
+	for (Iterator i = begin; i != end; ++i)
+		count += !less_than(*i);
+
+	if (count == 0)
+		return end;
+
+	Iterator target = std::next(begin, count - 1);
+	return equal_to(*target) ? target : end;
+}
+
+template <typename Iterator, typename T>
+constexpr Iterator counting_linear_search(Iterator begin, Iterator end, T&& key)
+{
+	return ::counting_linear_search_base(begin, end,
+		[&](auto& right) { return key < right; },
+		[&](auto& right) { return key == right; });
+}
+
+template <typename Collection, typename T>
+constexpr auto counting_linear_search(Collection&& collection, T&& key)
+{
+	return ::counting_linear_search(collection.begin(), collection.end(), std::forward<T>(key));
+}
+
+// For keys that are expensive to compare, such as strings, one three-way
+// comparison per probe replaces the separate less than and equality checks.
+// An equal element is remembered and the search continues to its right, so
+// the rightmost match is returned as by the other searches, without a second
+// comparison at the end. compare(right) returns a negative value, zero or a
+// positive value when the key sorts before, equal to or after right.
+
+template <typename Iterator, typename Compare>
+constexpr Iterator threeway_binary_search_base(Iterator begin, Iterator end, Compare&& compare)
+{
+	auto high = std::distance(begin, end);
+	decltype(high) low = 0;
+	Iterator found = end;
+
+	while (low < high)
+	{
+		const auto mid = low + (high - low) / 2;
+		const auto order = compare(*std::next(begin, mid));
+
+		if (order < 0)
+			high = mid;
+		else
+		{
+			if (order == 0)
+				found = std::next(begin, mid);
+			low = mid + 1;
+		}
+	}
+	return found;
+}
+
+// std::void_t is C++17, and the header otherwise only needs C++14.
+
+template <typename...>
+struct binary_search_make_void
+{
+	typedef void type;
+};
+
+template <typename T, typename U, typename = void>
+struct binary_search_has_compare : std::false_type
+{
+};
+
+template <typename T, typename U>
+struct binary_search_has_compare<T, U, typename binary_search_make_void<decltype(std::declval<const T&>().compare(std::declval<const U&>()))>::type> : std::true_type
+{
+};
+
+template <typename T, typename U>
+constexpr int binary_search_compare(const T& key, const U& right, std::true_type)
+{
+	return key.compare(right);
+}
+
+template <typename T, typename U>
+constexpr int binary_search_compare(const T& key, const U& right, std::false_type)
+{
+	return key < right ? -1 : right < key ? 1 : 0;
+}
+
+template <typename T, typename U>
+constexpr int binary_search_compare(const T& key, const U& right)
+{
+	return ::binary_search_compare(key, right, binary_search_has_compare<T, U>());
+}
+
+template <typename Iterator, typename T>
+constexpr Iterator threeway_binary_search(Iterator begin, Iterator end, T&& key)
+{
+	return ::threeway_binary_search_base(begin, end,
+		[&](auto& right) { return ::binary_search_compare(key, right); });
+}
+
+template <typename Collection, typename T>
+constexpr auto threeway_binary_search(Collection&& collection, T&& key)
+{
+	return ::threeway_binary_search(collection.begin(), collection.end(), std::forward<T>(key));
+}
+
+// Picks a kernel at compile time from the key type and an upper bound on the
+// array size, where MaxN = 0 means unbounded. The crossovers come from
+// best_search_bench.cpp. The counting scan wins on small arrays up to a limit
+// that depends on the key width and on AVX2, and the quaternary search wins on
+// everything larger; below 65536 elements it runs the tripletapped monobound
+// loop, which kept up with the plain monobound search at every size but the
+// tiniest. Keys without a cheap comparison go to the three-way search.
+
+enum class search_kernel
+{
+	counting_linear,
+	quaternary,
+	threeway
+};
+
+// The largest bound at which the counting scan beat both binary kernels on
+// every run of best_search_bench.cpp. Without AVX2 the 8-byte keys do not
+// vectorize and never won. Unmeasured widths follow the nearest measured type.
+
+template <typename T>
+constexpr size_t best_search_linear_limit()
+{
+#if defined(__AVX2__)
+	return sizeof(T) <= 4 ? 32 : sizeof(T) > 8 ? 0 : std::is_floating_point<T>::value ? 48 : 20;
+#else
+	return sizeof(T) <= 4 ? 32 : 0;
+#endif
+}
+
+template <typename T, size_t MaxN = 0>
+struct best_search
+{
+	static constexpr bool cheap = std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value;
+
+	static constexpr search_kernel kernel =
+		!cheap ? search_kernel::threeway :
+		MaxN != 0 && MaxN <= best_search_linear_limit<T>() ? search_kernel::counting_linear :
+		search_kernel::quaternary;
+
+	template <search_kernel Kernel>
+	using kernel_tag = std::integral_constant<search_kernel, Kernel>;
+
+	template <typename Iterator>
+	static constexpr Iterator find(Iterator begin, Iterator end, const T& key, kernel_tag<search_kernel::counting_linear>)
+	{
+		return ::counting_linear_search(begin, end, key);
+	}
+
+	template <typename Iterator>
+	static constexpr Iterator find(Iterator begin, Iterator end, const T& key, kernel_tag<search_kernel::quaternary>)
+	{
+		return ::monobound_quaternary_search(begin, end, key);
+	}
+
+	template <typename Iterator>
+	static constexpr Iterator find(Iterator begin, Iterator end, const T& key, kernel_tag<search_kernel::threeway>)
+	{
+		return ::threeway_binary_search(begin, end, key);
+	}
+
+	template <typename Iterator>
+	static constexpr Iterator find(Iterator begin, Iterator end, const T& key)
+	{
+		assert(MaxN == 0 || std::distance(begin, end) <= (decltype(std::distance(begin, end)))MaxN);
+		return find(begin, end, key, kernel_tag<kernel>());
+	}
+
+	template <typename Collection>
+	static constexpr auto find(Collection&& collection, const T& key)
+	{
+		return find(collection.begin(), collection.end(), key);
+	}
+};
+
 #endif
@@ -0,0 +1,550 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+*/
+
+/*
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Bulk lookup v1.0
+
+	Looks up a stream of 64 bit query keys in a sorted file of 64 bit keys,
+	for example to join a column against a dimension table. The key file is
+	mapped, not read. Queries are read in large chunks, and while a pool of
+	worker threads, started once, searches one chunk with
+	monobound_batch_search(), the next chunk is read and a pool thread writes
+	the results of the previous one, so neither reading nor writing stalls the
+	search.
+
+	Every query produces the index of its rightmost match in the key file, or
+	-1, in query order. With -p the matching record of a payload file that is
+	parallel to the key file is written instead, zero filled for misses.
+
+	Compile using: g++ -O3 -std=c++17 -pthread bulk_lookup.cpp -o bulk_lookup
+
+	Usage: bulk_lookup [options] <sorted int64 key file> [query file|-]
+
+	  -t          read the queries as text, one integer per line or word
+	  -T          write text: the key, the index and the payload in hex
+	  -p <file>   join with the records of a payload file
+	  -s          skip queries that are not found
+	  -j <n>      worker threads, the number of cores by default
+	  -c <n>      queries per chunk, 1048576 by default
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <vector>
+#include <algorithm>
+#include "binary_search.hpp"
+
+#define BULK_TEXT_BUFFER (1 << 20)
+
+static const int64_t *index_keys;
+static size_t index_size;
+static const unsigned char *payload;
+static size_t payload_width;
+
+static int text_in, text_out, hits_only;
+
+// Maps a whole file read only. Empty files map to a valid empty range.
+
+static const void *map_file(const char *path, size_t *size)
+{
+	static const char empty[1] = { 0 };
+	struct stat info;
+	int fd = open(path, O_RDONLY);
+
+	if (fd == -1 || fstat(fd, &info) == -1)
+	{
+		perror(path);
+		if (fd != -1)
+			close(fd);
+		return NULL;
+	}
+
+	*size = info.st_size;
+
+	if (*size == 0)
+	{
+		close(fd);
+		return empty;
+	}
+
+	void *map = mmap(NULL, *size, PROT_READ, MAP_SHARED, fd, 0);
+
+	close(fd);
+
+	if (map == MAP_FAILED)
+	{
+		perror(path);
+		return NULL;
+	}
+	madvise(map, *size, MADV_RANDOM);
+
+	return map;
+}
+
+static int is_separator(char c)
+{
+	return c == ' ' || c == '\t' || c == '\r' || c == '\n' || c == ',';
+}
+
+// Reads query keys in chunks, as raw int64 or as text. A text token that
+// straddles two reads is moved to the front of the buffer and completed by
+// the next read.
+
+struct query_reader
+{
+	FILE *fp;
+	std::vector<char> buffer;
+	size_t pos = 0, len = 0;
+	int eof = 0, error = 0;
+
+	int refill()
+	{
+		memmove(buffer.data(), buffer.data() + pos, len - pos);
+		len -= pos;
+		pos = 0;
+
+		size_t got = fread(buffer.data() + len, 1, buffer.size() - len, fp);
+
+		len += got;
+
+		if (got == 0)
+			eof = 1;
+
+		return got != 0;
+	}
+
+	size_t read_text(int64_t *out, size_t max)
+	{
+		size_t count = 0;
+
+		while (count < max)
+		{
+			while (pos < len && is_separator(buffer[pos]))
+				pos++;
+
+			size_t end = pos;
+
+			while (end < len && !is_separator(buffer[end]))
+				end++;
+
+			if (end == len && !eof)
+			{
+				if (pos == 0 && len == buffer.size())
+				{
+					fprintf(stderr, "query token too long\n");
+					error = 1;
+					return count;
+				}
+				refill();
+				continue;
+			}
+
+			if (pos == end)
+				return count;
+
+			// parse [-]digits without strtoll, which needs a terminated string
+
+			size_t cnt = pos;
+			int negative = buffer[cnt] == '-';
+			uint64_t value = 0, limit = negative ? (uint64_t) INT64_MAX + 1 : (uint64_t) INT64_MAX;
+
+			cnt += negative;
+
+			if (cnt == end)
+				error = 1;
+
+			for ( ; cnt < end ; cnt++)
+			{
+				unsigned int digit = buffer[cnt] - '0';
+
+				if (buffer[cnt] < '0' || buffer[cnt] > '9' || value > (limit - digit) / 10)
+				{
+					error = 1;
+					break;
+				}
+				value = value * 10 + digit;
+			}
+
+			if (error)
+			{
+				fprintf(stderr, "bad or out of range query key '%.*s'\n", (int) (end - pos), buffer.data() + pos);
+				return count;
+			}
+
+			out[count++] = negative ? (int64_t) (0 - value) : (int64_t) value;
+			pos = end;
+		}
+		return count;
+	}
+
+	size_t read(int64_t *out, size_t max)
+	{
+		if (text_in)
+		{
+			return read_text(out, max);
+		}
+
+		// read bytes rather than records, so a truncated last record is seen
+
+		size_t got = fread(out, 1, max * sizeof(int64_t), fp);
+
+		if (got % sizeof(int64_t))
+		{
+			fprintf(stderr, "query file ends in a partial record of %zu bytes\n", got % sizeof(int64_t));
+			error = 1;
+		}
+		return got / sizeof(int64_t);
+	}
+};
+
+// A fixed set of threads that is started once. run() hands job(i) to thread i
+// and returns once every thread has finished it, so a round costs a wakeup
+// instead of a thread start.
+
+struct worker_pool
+{
+	std::vector<std::thread> threads;
+	std::mutex lock;
+	std::condition_variable wake, idle;
+	std::function<void(unsigned int)> job;
+	unsigned long long round = 0;
+	unsigned int busy = 0;
+	int quit = 0;
+
+	explicit worker_pool(unsigned int count)
+	{
+		for (unsigned int index = 0 ; index < count ; index++)
+		{
+			threads.emplace_back([this, index] { work(index); });
+		}
+	}
+
+	~worker_pool()
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			quit = 1;
+		}
+		wake.notify_all();
+
+		for (auto& thread : threads)
+			thread.join();
+	}
+
+	void work(unsigned int index)
+	{
+		unsigned long long seen = 0;
+
+		while (1)
+		{
+			std::unique_lock<std::mutex> guard(lock);
+
+			wake.wait(guard, [&] { return quit || round != seen; });
+
+			if (quit)
+				return;
+
+			seen = round;
+			guard.unlock();
+
+			job(index);
+
+			guard.lock();
+
+			if (--busy == 0)
+				idle.notify_one();
+		}
+	}
+
+	void start(std::function<void(unsigned int)> next)
+	{
+		{
+			std::lock_guard<std::mutex> guard(lock);
+			job = std::move(next);
+			busy = threads.size();
+			round++;
+		}
+		wake.notify_all();
+	}
+
+	void finish()
+	{
+		std::unique_lock<std::mutex> guard(lock);
+
+		idle.wait(guard, [&] { return busy == 0; });
+	}
+};
+
+// Searches a slice of a chunk.
+
+static void search(const int64_t *queries, size_t count, int64_t *results)
+{
+	const int64_t *found[monobound_batch_width];
+
+	for (size_t base = 0 ; base < count ; base += monobound_batch_width)
+	{
+		size_t group = std::min(count - base, (size_t) monobound_batch_width);
+
+		monobound_batch_search(index_keys, index_keys + index_size, queries + base, queries + base + group, found);
+
+		for (size_t cnt = 0 ; cnt < group ; cnt++)
+		{
+			results[base + cnt] = found[cnt] == index_keys + index_size ? -1 : found[cnt] - index_keys;
+		}
+	}
+}
+
+// Formats a chunk of results and writes it with a single fwrite. Returns the
+// number of hits, or -1 on a write error.
+
+static long long write_results(FILE *fp, const int64_t *queries, const int64_t *results, size_t count, std::vector<char>& out)
+{
+	static const char hex[] = "0123456789abcdef";
+	long long hits = 0;
+
+	out.clear();
+
+	for (size_t cnt = 0 ; cnt < count ; cnt++)
+	{
+		int64_t index = results[cnt];
+
+		if (index >= 0)
+			hits++;
+		else if (hits_only)
+			continue;
+
+		if (text_out)
+		{
+			char line[64];
+			int length = snprintf(line, sizeof(line), "%lld\t%lld", (long long) queries[cnt], (long long) index);
+
+			out.insert(out.end(), line, line + length);
+
+			if (payload)
+			{
+				out.push_back('\t');
+
+				for (size_t byte = 0 ; byte < payload_width ; byte++)
+				{
+					unsigned char c = index >= 0 ? payload[index * payload_width + byte] : 0;
+
+					out.push_back(hex[c >> 4]);
+					out.push_back(hex[c & 15]);
+				}
+			}
+			out.push_back('\n');
+		}
+		else if (payload)
+		{
+			if (index >= 0)
+				out.insert(out.end(), payload + index * payload_width, payload + (index + 1) * payload_width);
+			else
+				out.insert(out.end(), payload_width, 0);
+		}
+		else
+		{
+			const char *raw = (const char *) &index;
+
+			out.insert(out.end(), raw, raw + sizeof(index));
+		}
+	}
+
+	if (!out.empty() && fwrite(out.data(), 1, out.size(), fp) != out.size())
+	{
+		return -1;
+	}
+	return hits;
+}
+
+int main(int argc, char **argv)
+{
+	const char *payload_path = NULL;
+	unsigned int threads = std::max(1U, std::thread::hardware_concurrency());
+	size_t chunk = 1 << 20;
+	int opt;
+
+	while ((opt = getopt(argc, argv, "tTp:sj:c:")) != -1)
+	{
+		switch (opt)
+		{
+			case 't': text_in = 1; break;
+			case 'T': text_out = 1; break;
+			case 'p': payload_path = optarg; break;
+			case 's': hits_only = 1; break;
+			case 'j': threads = std::max(1, atoi(optarg)); break;
+			case 'c': chunk = std::max(1LL, atoll(optarg)); break;
+			default:
+				fprintf(stderr, "usage: %s [-tTs] [-p payload] [-j threads] [-c chunk] <sorted int64 key file> [query file|-]\n", argv[0]);
+				return 1;
+		}
+	}
+
+	if (optind >= argc)
+	{
+		fprintf(stderr, "usage: %s [-tTs] [-p payload] [-j threads] [-c chunk] <sorted int64 key file> [query file|-]\n", argv[0]);
+		return 1;
+	}
+
+	size_t size;
+
+	index_keys = (const int64_t *) map_file(argv[optind], &size);
+
+	if (index_keys == NULL)
+	{
+		return 1;
+	}
+	index_size = size / sizeof(int64_t);
+
+	if (size % sizeof(int64_t))
+	{
+		fprintf(stderr, "%s: ends in a partial key of %zu bytes\n", argv[optind], size % sizeof(int64_t));
+		return 1;
+	}
+
+	if (!std::is_sorted(index_keys, index_keys + index_size))
+	{
+		fprintf(stderr, "%s: keys are not sorted\n", argv[optind]);
+		return 1;
+	}
+
+	if (payload_path)
+	{
+		payload = (const unsigned char *) map_file(payload_path, &size);
+
+		if (payload == NULL)
+		{
+			return 1;
+		}
+
+		if (index_size == 0 || size % index_size)
+		{
+			fprintf(stderr, "%s: size is not a multiple of the %zu keys\n", payload_path, index_size);
+			return 1;
+		}
+		payload_width = size / index_size;
+	}
+
+	query_reader reader;
+	const char *query_path = optind + 1 < argc ? argv[optind + 1] : "-";
+
+	reader.fp = strcmp(query_path, "-") ? fopen(query_path, "rb") : stdin;
+
+	if (reader.fp == NULL)
+	{
+		perror(query_path);
+		return 1;
+	}
+
+	if (text_in)
+	{
+		reader.buffer.resize(BULK_TEXT_BUFFER);
+	}
+
+	// Three query buffers rotate between reader, workers and writer, two
+	// result buffers between workers and writer.
+
+	std::vector<int64_t> queries[3], results[2];
+	std::vector<char> formatted;
+
+	for (auto& buffer : queries)
+		buffer.resize(chunk);
+	for (auto& buffer : results)
+		buffer.resize(chunk);
+
+	// threads searchers, plus one more thread that writes the previous chunk
+
+	worker_pool pool(threads + 1);
+	long long total = 0, hits = 0;
+	size_t current = reader.read(queries[0].data(), chunk), previous = 0;
+
+	for (size_t round = 0 ; current || previous ; round++)
+	{
+		const int64_t *done_queries = queries[(round + 2) % 3].data();
+		const int64_t *done_results = results[(round + 1) % 2].data();
+		const int64_t *search_queries = queries[round % 3].data();
+		int64_t *search_results = results[round % 2].data();
+		size_t slice = (current + threads - 1) / threads;
+		long long written = 0;
+
+		pool.start([&](unsigned int index)
+		{
+			if (index == threads)
+			{
+				written = write_results(stdout, done_queries, done_results, previous, formatted);
+				return;
+			}
+
+			size_t first = index * slice;
+
+			if (first < current)
+			{
+				search(search_queries + first, std::min(slice, current - first), search_results + first);
+			}
+		});
+
+		size_t next = current && !reader.error ? reader.read(queries[(round + 1) % 3].data(), chunk) : 0;
+
+		pool.finish();
+
+		if (written < 0)
+		{
+			perror("write");
+			return 1;
+		}
+		hits += written;
+		total += current;
+
+		previous = current;
+		current = next;
+	}
+
+	if (fflush(stdout))
+	{
+		perror("write");
+		return 1;
+	}
+
+	fprintf(stderr, "%lld queries, %lld hits\n", total, hits);
+
+	int failed = reader.error || ferror(reader.fp);
+
+	if (failed && !reader.error)
+		perror(query_path);
+
+	if (reader.fp != stdin)
+		fclose(reader.fp);
+
+	return failed;
+}
@@ -0,0 +1,134 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef CSR_MATRIX_HPP
+#define CSR_MATRIX_HPP
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+#include "binary_search.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#endif
+
+
+
+// Element access on a compressed sparse row matrix. Every row's column
+// indices are sorted and unique, so A(i, j) is a search of row i's slice.
+// Rows are usually short and vary wildly in length, so the search is picked
+// per row: a SIMD equality scan for short rows, the tripletapped binary search
+// for medium rows and the monobound binary search for long ones. The view does
+// not own any of the arrays.
+
+template <typename Value, typename Index = int32_t, typename Offset = size_t>
+class csr_view
+{
+	size_t row_count;
+	const Offset* offsets;
+	const Index* columns;
+	const Value* values;
+
+	static constexpr size_t gather_distance = 8;
+
+	static const Index* scan(const Index* first, const Index* last, Index j)
+	{
+#if defined(__SSE2__) || defined(_M_X64)
+		if (sizeof(Index) == 4 && std::is_integral<Index>::value)
+		{
+			const __m128i key = _mm_set1_epi32((int32_t)j);
+
+			for (; last - first >= 4; first += 4)
+			{
+				const int mask = _mm_movemask_ps(_mm_castsi128_ps(_mm_cmpeq_epi32(_mm_loadu_si128((const __m128i*)first), key)));
+				if (mask)
+					return first + (mask & 1 ? 0 : mask & 2 ? 1 : mask & 4 ? 2 : 3);
+			}
+		}
+#endif
+		for (; first != last; ++first)
+			if (*first == j)
+				return first;
+		return nullptr;
+	}
+
+public:
+	static constexpr size_t npos = (size_t)-1;
+	static constexpr size_t scan_limit = 16;
+	static constexpr size_t tripletapped_limit = 256;
+
+	constexpr csr_view(size_t rows, const Offset* offsets, const Index* columns, const Value* values)
+		: row_count(rows), offsets(offsets), columns(columns), values(values)
+	{
+	}
+
+	size_t rows() const { return row_count; }
+
+	// The position of A(i, j) in the column and value arrays, or npos.
+
+	size_t find(size_t i, Index j) const
+	{
+		assert(i < row_count);
+		const Index* first = columns + offsets[i];
+		const Index* last = columns + offsets[i + 1];
+		const Index* found;
+
+		if ((size_t)(last - first) <= scan_limit)
+			found = scan(first, last, j);
+		else if ((size_t)(last - first) <= tripletapped_limit)
+			found = ::tripletapped_binary_search(first, last, j);
+		else
+			found = ::monobound_binary_search(first, last, j);
+
+		return found == nullptr || found == last ? npos : (size_t)(found - columns);
+	}
+
+	Value at(size_t i, Index j, Value zero = Value()) const
+	{
+		const size_t position = find(i, j);
+		return position == npos ? zero : values[position];
+	}
+
+	// Writes A(rows[k], cols[k]) to out[k]. Accesses to different rows are
+	// pipelined: the row offsets are prefetched gather_distance pairs ahead,
+	// and the start of the column slice half that distance ahead, so each
+	// search begins on warm cache lines.
+
+	void gather(const size_t* rows, const Index* cols, size_t count, Value* out, Value zero = Value()) const
+	{
+		for (size_t k = 0; k != count; ++k)
+		{
+			if (k + gather_distance < count)
+				BINARY_SEARCH_PREFETCH(&offsets[rows[k + gather_distance]]);
+			if (k + gather_distance / 2 < count)
+			{
+				const size_t row = rows[k + gather_distance / 2];
+				const Offset first = offsets[row], last = offsets[row + 1];
+				BINARY_SEARCH_PREFETCH(&columns[first]);
+				BINARY_SEARCH_PREFETCH(&columns[first + (last - first) / 2]);
+			}
+			out[k] = at(rows[k], cols[k], zero);
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,150 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DICTIONARY_ENCODE_HPP
+#define DICTIONARY_ENCODE_HPP
+#include <vector>
+#include <utility>
+#include <algorithm>
+#include <cstddef>
+#include "binary_search.hpp"
+
+
+
+// Maps every value to its position in a sorted, duplicate free dictionary.
+// Values that are not in the dictionary get the miss code and, if candidates
+// is given, are appended to it once each in ascending order, ready to be
+// merged into the next dictionary. Returns the number of misses.
+//
+// A batch that is large relative to the dictionary is sorted and merged into
+// it, galloping over dictionary stretches that the batch skips. A small batch
+// is searched as is with the prefetched monobound_batch_search(), which is
+// cheaper than sorting it.
+
+constexpr size_t dictionary_merge_ratio = 16;
+
+template <typename T, typename Code>
+size_t dictionary_encode(const T* values, size_t count, const T* dictionary, size_t size, Code* codes, std::vector<T>* candidates = nullptr, Code miss = Code(-1))
+{
+	const size_t first_candidate = candidates != nullptr ? candidates->size() : 0;
+	size_t misses = 0;
+
+	if (count * dictionary_merge_ratio >= size)
+	{
+		std::vector<std::pair<T, size_t>> sorted(count);
+
+		for (size_t i = 0; i != count; ++i)
+			sorted[i] = { values[i], i };
+		std::sort(sorted.begin(), sorted.end(),
+			[](const std::pair<T, size_t>& left, const std::pair<T, size_t>& right) { return left.first < right.first; });
+
+		size_t pos = 0;
+
+		for (size_t i = 0; i != count; ++i)
+		{
+			const T& value = sorted[i].first;
+
+			if (i == 0 || sorted[i - 1].first < value)
+			{
+				// gallop to the first dictionary entry >= value
+
+				if (pos < size && dictionary[pos] < value)
+				{
+					size_t bot = pos, top = 1;
+
+					while (true)
+					{
+						if (bot + top >= size)
+						{
+							top = size - bot;
+							break;
+						}
+						if (!(dictionary[bot + top] < value))
+							break;
+						bot += top;
+						top *= 2;
+					}
+
+					while (top > 1)
+					{
+						const size_t mid = top / 2;
+						if (dictionary[bot + mid] < value)
+							bot += mid;
+						top -= mid;
+					}
+					pos = bot + 1;
+				}
+
+				if ((pos == size || value < dictionary[pos]) && candidates != nullptr)
+					candidates->push_back(value);
+			}
+
+			if (pos < size && !(value < dictionary[pos]))
+				codes[sorted[i].second] = (Code)pos;
+			else
+			{
+				codes[sorted[i].second] = miss;
+				++misses;
+			}
+		}
+		return misses;
+	}
+
+	const T* found[monobound_batch_width];
+
+	for (size_t base = 0; base < count; base += monobound_batch_width)
+	{
+		const size_t group = count - base < monobound_batch_width ? count - base : monobound_batch_width;
+
+		::monobound_batch_search_base(dictionary, dictionary + size, values + base, values + base + group, found,
+			[](const T& key, const T& right) { return key < right; },
+			[](const T& key, const T& right) { return !(right < key) && !(key < right); });
+
+		for (size_t j = 0; j != group; ++j)
+		{
+			if (found[j] != dictionary + size)
+				codes[base + j] = (Code)(found[j] - dictionary);
+			else
+			{
+				codes[base + j] = miss;
+				++misses;
+				if (candidates != nullptr)
+					candidates->push_back(values[base + j]);
+			}
+		}
+	}
+
+	if (candidates != nullptr)
+	{
+		std::sort(candidates->begin() + first_candidate, candidates->end());
+		candidates->erase(std::unique(candidates->begin() + first_candidate, candidates->end()), candidates->end());
+	}
+	return misses;
+}
+
+template <typename T, typename Code>
+size_t dictionary_encode(const std::vector<T>& values, const std::vector<T>& dictionary, Code* codes, std::vector<T>* candidates = nullptr, Code miss = Code(-1))
+{
+	return ::dictionary_encode(values.data(), values.size(), dictionary.data(), dictionary.size(), codes, candidates, miss);
+}
+
+#endif
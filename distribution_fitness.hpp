@@ -0,0 +1,290 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef DISTRIBUTION_FITNESS_HPP
+#define DISTRIBUTION_FITNESS_HPP
+#include <cmath>
+#include <cstring>
+#include <cstdint>
+#include <cstddef>
+#include "binary_search.hpp"
+
+
+
+// How well a sorted array of numbers suits interpolation, measured in one
+// pass when an index is built. Every distinct key is placed by three models
+// and the distance to its rightmost position is the error of that model:
+//
+//	interpolated	one line through the first and the last element, as
+//			monobound_interpolated_search() estimates
+//	piecewise	a line per distribution_fitness_pieces equal slices,
+//			found by a search over the slice boundaries
+//	learned		a line per distribution_fitness_leaves equal slices,
+//			as the leaves of a two-level learned index whose
+//			root is the single line
+//
+// The expected probes of each search follow from the errors: an estimate
+// that is e elements off costs about 2 * log2(e + 2) probes to correct with
+// an exponential search. The recommendation is the search with the fewest
+// probes, except that arrays below distribution_fitness_minimum elements
+// always get monobound, where a guess does not pay off.
+
+constexpr size_t distribution_fitness_pieces = 64;
+constexpr size_t distribution_fitness_leaves = 1024;
+constexpr size_t distribution_fitness_minimum = 1000;
+constexpr size_t distribution_fitness_buckets = 64;
+
+enum class search_recommendation
+{
+	monobound,
+	interpolated,
+	piecewise,
+	learned
+};
+
+inline const char* search_recommendation_name(search_recommendation search)
+{
+	switch (search)
+	{
+	case search_recommendation::interpolated:
+		return "interpolated";
+	case search_recommendation::piecewise:
+		return "piecewise";
+	case search_recommendation::learned:
+		return "learned";
+	default:
+		return "monobound";
+	}
+}
+
+struct distribution_fitness
+{
+	size_t size = 0;
+	size_t distinct = 0;
+
+	// errors of the single line in elements. histogram[b] counts the
+	// distinct keys with an error e of 2^(b - 1) <= e < 2^b, and
+	// histogram[0] those off by less than one element
+
+	double max_error = 0;
+	double mean_error = 0;
+	size_t histogram[distribution_fitness_buckets] = {};
+
+	double piecewise_max_error = 0;
+	double piecewise_mean_error = 0;
+	double learned_max_error = 0;
+	double learned_mean_error = 0;
+
+	// runs of equal keys longer than one element
+
+	size_t duplicate_runs = 0;
+	size_t max_run = 0;
+	double mean_run = 0;
+
+	// differences between consecutive distinct keys
+
+	double min_gap = 0;
+	double max_gap = 0;
+	double mean_gap = 0;
+	double gap_deviation = 0;
+
+	// expected probes per search, indexed by search_recommendation
+
+	double probes[4] = {};
+
+	search_recommendation recommendation = search_recommendation::monobound;
+};
+
+// log2 of a positive double, exact at powers of two and linear between them,
+// which is off by at most 0.09. It is read from the bits, as the analysis
+// takes a logarithm per key and model.
+
+inline double distribution_fitness_log2(double value)
+{
+	uint64_t bits;
+
+	std::memcpy(&bits, &value, sizeof(bits));
+	return (double)(int64_t)(bits >> 52) - 1023 + (double)(bits & 0xFFFFFFFFFFFFFULL) / 4503599627370496.0;
+}
+
+// The error statistics of one model that splits the array into equal slices
+// and interpolates between the first and the last element of each.
+
+struct distribution_fitness_model
+{
+	size_t slices, slice = 0, first = 0, last = 0;
+	double scale = 0, max_error = 0, sum_error = 0, sum_cost = 0;
+
+	explicit distribution_fitness_model(size_t slices) : slices(slices) {}
+
+	static double cost(double error)
+	{
+		return 2 * ::distribution_fitness_log2(error + 2);
+	}
+
+	template <typename Iterator>
+	double place(Iterator begin, size_t size, size_t index)
+	{
+		if (index > last || slice == 0)
+		{
+			while (index > last || slice == 0)
+			{
+				first = slice * size / slices;
+				last = ++slice * size / slices - 1;
+			}
+
+			const double range = ::interpolation_search_distance(*std::next(begin, last), *std::next(begin, first));
+
+			scale = range > 0 ? (last - first) / range : 0;
+		}
+
+		const double estimate = scale != 0 ? first + ::interpolation_search_distance(*std::next(begin, index), *std::next(begin, first)) * scale : (double)last;
+		const double error = std::fabs(estimate - (double)index);
+
+		if (error > max_error)
+			max_error = error;
+		sum_error += error;
+		sum_cost += cost(error);
+		return error;
+	}
+};
+
+template <typename Iterator>
+distribution_fitness analyze_distribution(Iterator begin, Iterator end)
+{
+	distribution_fitness fitness;
+	const size_t size = (size_t)std::distance(begin, end);
+
+	fitness.size = size;
+
+	if (size == 0)
+		return fitness;
+
+	distribution_fitness_model global(1);
+	distribution_fitness_model pieces(size < distribution_fitness_pieces ? size : distribution_fitness_pieces);
+	distribution_fitness_model leaves(size < distribution_fitness_leaves ? size : distribution_fitness_leaves);
+	const double leaf_size = (double)size / leaves.slices;
+	size_t run = 1, run_total = 0, previous = 0;
+	double gap_sum = 0, gap_square = 0, route_cost = 0;
+
+	for (size_t index = 0; index != size; ++index)
+	{
+		const auto& key = *std::next(begin, index);
+
+		// a search ends on the rightmost copy of a key, so the models are
+		// measured at the end of every run
+
+		if (index + 1 != size && !(key < *std::next(begin, index + 1)))
+		{
+			++run;
+			continue;
+		}
+
+		if (run > 1)
+		{
+			++fitness.duplicate_runs;
+			run_total += run;
+			if (run > fitness.max_run)
+				fitness.max_run = run;
+			run = 1;
+		}
+
+		const double error = global.place(begin, size, index);
+		const size_t bucket = error < 1 ? 0 : (size_t)::distribution_fitness_log2(error) + 1;
+
+		++fitness.histogram[bucket < distribution_fitness_buckets ? bucket : distribution_fitness_buckets - 1];
+
+		// a learned index routes with the single line, an error of one leaf
+		// costs as much as an error of one element within a leaf
+
+		route_cost += distribution_fitness_model::cost(error / leaf_size);
+
+		pieces.place(begin, size, index);
+		leaves.place(begin, size, index);
+
+		if (fitness.distinct++ != 0)
+		{
+			const double gap = ::interpolation_search_distance(key, *std::next(begin, previous));
+
+			if (fitness.distinct == 2 || gap < fitness.min_gap)
+				fitness.min_gap = gap;
+			if (gap > fitness.max_gap)
+				fitness.max_gap = gap;
+			gap_sum += gap;
+			gap_square += gap * gap;
+		}
+		previous = index;
+	}
+
+	const double distinct = (double)fitness.distinct;
+
+	fitness.max_error = global.max_error;
+	fitness.mean_error = global.sum_error / distinct;
+	fitness.piecewise_max_error = pieces.max_error;
+	fitness.piecewise_mean_error = pieces.sum_error / distinct;
+	fitness.learned_max_error = leaves.max_error;
+	fitness.learned_mean_error = leaves.sum_error / distinct;
+
+	if (fitness.duplicate_runs != 0)
+		fitness.mean_run = (double)run_total / fitness.duplicate_runs;
+
+	if (fitness.distinct > 1)
+	{
+		const double gaps = distinct - 1;
+
+		fitness.mean_gap = gap_sum / gaps;
+		fitness.gap_deviation = std::sqrt(std::fmax(gap_square / gaps - fitness.mean_gap * fitness.mean_gap, 0.0));
+	}
+
+	// the interpolated search checks both ends first, the piecewise search
+	// pays for a monobound search over its slices and the learned index for
+	// reading the leaf it was routed to
+
+	fitness.probes[(size_t)search_recommendation::monobound] = std::log2((double)size) + 1;
+	fitness.probes[(size_t)search_recommendation::interpolated] = 2 + global.sum_cost / distinct;
+	fitness.probes[(size_t)search_recommendation::piecewise] = std::log2((double)pieces.slices) + 1 + pieces.sum_cost / distinct;
+	fitness.probes[(size_t)search_recommendation::learned] = 1 + (route_cost + leaves.sum_cost) / distinct;
+
+	// the piecewise and learned searches need a table of slices next to the
+	// array, so they have to save a quarter of the probes of every simpler
+	// search to be worth it
+
+	if (size >= distribution_fitness_minimum)
+	{
+		for (size_t search = 1; search != 4; ++search)
+		{
+			const double margin = search >= (size_t)search_recommendation::piecewise ? 0.75 : 1.0;
+
+			if (fitness.probes[search] < fitness.probes[(size_t)fitness.recommendation] * margin)
+				fitness.recommendation = (search_recommendation)search;
+		}
+	}
+	return fitness;
+}
+
+template <typename Collection>
+distribution_fitness analyze_distribution(Collection&& collection)
+{
+	return ::analyze_distribution(collection.begin(), collection.end());
+}
+
+#endif
@@ -0,0 +1,183 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+*/
+
+/*
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Compares the interpolated searches against the monobound binary search
+	on 64 bit keys with uniform and smooth non-linear distributions. Half of
+	the queries are keys from the array. Checks is the mean number of
+	comparisons per query, and Hits should agree between all rows of a
+	distribution.
+
+	Compile using: g++ -O3 -march=native -std=c++17 interpolation_search_bench.cpp
+
+	Usage: interpolation_search_bench [items] [runs] [queries] [seed]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <stdint.h>
+#include <time.h>
+#include <math.h>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <plf_nanotimer_c_api.h>
+#include "binary_search.hpp"
+
+static std::vector<int64_t> keys, queries;
+static long long max;
+static int runs, loop, rnd;
+
+template <typename Search>
+static void execute(Search&& search, const char *algo_name)
+{
+	nanotimer_data_t timer;
+	double best = 0;
+	long long hits = 0, checks = 0;
+
+	for (int64_t query : queries)
+	{
+		search(query,
+			[&](int64_t key, int64_t right) { return ++checks, key < right; },
+			[&](int64_t key, int64_t right) { return ++checks, key == right; });
+	}
+
+	nanotimer(&timer);
+
+	for (int run = runs ; run ; --run)
+	{
+		hits = 0;
+
+		nanotimer_start(&timer);
+
+		for (int64_t query : queries)
+		{
+			hits += search(query,
+				[](int64_t key, int64_t right) { return key < right; },
+				[](int64_t key, int64_t right) { return key == right; }) != keys.end();
+		}
+
+		double duration = nanotimer_get_elapsed_us(&timer);
+
+		if (best == 0 || duration < best)
+		{
+			best = duration;
+		}
+	}
+
+	printf("| %30s | %10lld | %10lld | %10.1f | %10f |\n", algo_name, max, hits, (double) checks / loop, best / 1000000.0);
+}
+
+template <typename Generate>
+static void distribution(const char *name, Generate&& generate)
+{
+	std::mt19937_64 gen(rnd);
+
+	for (long long cnt = 0 ; cnt < max ; cnt++)
+	{
+		keys[cnt] = generate(gen, cnt);
+	}
+	std::sort(keys.begin(), keys.end());
+
+	for (int cnt = 0 ; cnt < loop ; cnt++)
+	{
+		if (cnt % 2)
+		{
+			queries[cnt] = keys[gen() % max];
+		}
+		else
+		{
+			queries[cnt] = (int64_t) ((uint64_t) keys[0] + (uint64_t) ((double) (gen() >> 11) / 9007199254740992.0 * interpolation_search_distance(keys[max - 1], keys[0])));
+		}
+	}
+
+	printf("\n%s\n\n", name);
+
+	printf("| %30s | %10s | %10s | %10s | %10s |\n", "Name", "Items", "Hits", "Checks", "Time");
+	printf("| %30s | %10s | %10s | %10s | %10s |\n", "----------", "----------", "----------", "----------", "----------");
+
+	execute([](int64_t query, auto&& less_than, auto&& equal_to)
+	{
+		return ::monobound_binary_search(keys.begin(), keys.end(), query, less_than, equal_to);
+	}, "monobound_binary_search");
+
+	execute([](int64_t query, auto&& less_than, auto&& equal_to)
+	{
+		return ::monobound_interpolated_search(keys.begin(), keys.end(), query, less_than, equal_to);
+	}, "monobound_interpolated_search");
+
+	execute([](int64_t query, auto&& less_than, auto&& equal_to)
+	{
+		return ::interpolation_sequential_search(keys.begin(), keys.end(), query, less_than, equal_to);
+	}, "interpolation_sequential");
+
+	execute([](int64_t query, auto&& less_than, auto&& equal_to)
+	{
+		return ::three_point_interpolation_search(keys.begin(), keys.end(), query, less_than, equal_to);
+	}, "three_point_interpolation");
+}
+
+int main(int argc, char **argv)
+{
+	max = 1000000;
+	runs = 10;
+	loop = 1000000;
+	rnd = time(NULL);
+
+	if (argc > 1)
+		max = atoll(argv[1]);
+
+	if (argc > 2)
+		runs = atoi(argv[2]);
+
+	if (argc > 3)
+		loop = atoi(argv[3]);
+
+	if (argc > 4)
+		rnd = atoi(argv[4]);
+
+	if (max < 1 || loop < 1)
+	{
+		fprintf(stderr, "%s: needs at least one key and one query\n", argv[0]);
+		return 1;
+	}
+
+	keys.resize(max);
+	queries.resize(loop);
+
+	printf("Benchmark: keys: %lld, runs: %d, queries: %d, seed: %d\n", max, runs, loop, rnd);
+
+	distribution("Uniform", [](std::mt19937_64& gen, long long) { return (int64_t) (gen() % (max * 16)); });
+
+	distribution("Uniform over the full 64 bit range", [](std::mt19937_64& gen, long long) { return (int64_t) gen(); });
+
+	distribution("Quadratic", [](std::mt19937_64& gen, long long cnt) { return (int64_t) cnt * cnt + (int64_t) (gen() % 16); });
+
+	distribution("Exponential", [](std::mt19937_64& gen, long long cnt) { return (int64_t) (exp(30.0 * cnt / max) * 1000.0) + (int64_t) (gen() % 16); });
+
+	distribution("Lognormal", [](std::mt19937_64& gen, long long) { return (int64_t) (std::lognormal_distribution<double>(0.0, 1.0)(gen) * 1000000000.0); });
+
+	return 0;
+}
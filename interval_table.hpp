@@ -0,0 +1,232 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef INTERVAL_TABLE_HPP
+#define INTERVAL_TABLE_HPP
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include "binary_search.hpp"
+
+
+
+enum class interval_layout
+{
+	monobound,
+	eytzinger
+};
+
+// Maps a key to the non-overlapping, inclusive interval [first, last] that
+// contains it, for instance IP address ranges or symbol address ranges. The
+// interval starts live in their own column, either sorted for a monobound
+// search or in Eytzinger (breadth first) order, while the ends and values are
+// kept in sorted order in parallel columns. A lookup is a predecessor search on
+// the starts followed by a single check against the matching end.
+
+template <typename Key, typename Value, interval_layout Layout = interval_layout::monobound>
+class interval_table
+{
+public:
+	struct interval
+	{
+		Key first, last;
+		Value value;
+	};
+
+	static constexpr size_t npos = (size_t)-1;
+
+private:
+	std::vector<Key> starts;
+	std::vector<Key> lasts;
+	std::vector<Value> values;
+	std::vector<size_t> ranks;
+
+	static size_t trailing_ones(size_t k)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return __builtin_ctzll(~(unsigned long long)k);
+#else
+		size_t count = 0;
+		while (k & 1)
+		{
+			k >>= 1;
+			++count;
+		}
+		return count;
+#endif
+	}
+
+	size_t build_eytzinger(const std::vector<Key>& sorted, size_t i, size_t k)
+	{
+		if (k < starts.size())
+		{
+			i = build_eytzinger(sorted, i, 2 * k);
+			starts[k] = sorted[i];
+			ranks[k] = i++;
+			i = build_eytzinger(sorted, i, 2 * k + 1);
+		}
+		return i;
+	}
+
+	// The sorted position of the interval that would contain x, which still
+	// has to be checked against its last key.
+
+	size_t predecessor(const Key& x) const
+	{
+		if (Layout == interval_layout::eytzinger)
+		{
+			size_t k = 1;
+			while (k < starts.size())
+				k = 2 * k + !(x < starts[k]);
+			k >>= trailing_ones(k) + 1;
+			return (k ? ranks[k] : lasts.size()) - 1;
+		}
+		else
+		{
+			auto found = ::monobound_binary_search_base(starts.begin(), starts.end(),
+				[&](auto& right) { return x < right; },
+				[&](auto& right) { return !(x < right); });
+			return found == starts.end() ? npos : (size_t)(found - starts.begin());
+		}
+	}
+
+	size_t verify(size_t index, const Key& x) const
+	{
+		return index != npos && !(lasts[index] < x) ? index : npos;
+	}
+
+public:
+	interval_table() = default;
+
+	// The intervals may be given in any order but must not overlap.
+
+	explicit interval_table(std::vector<interval> intervals)
+	{
+		std::sort(intervals.begin(), intervals.end(),
+			[](const interval& left, const interval& right) { return left.first < right.first; });
+
+		std::vector<Key> sorted;
+		sorted.reserve(intervals.size());
+		lasts.reserve(intervals.size());
+		values.reserve(intervals.size());
+
+		for (size_t i = 0; i != intervals.size(); ++i)
+		{
+			assert(!(intervals[i].last < intervals[i].first));
+			assert(i == 0 || intervals[i - 1].last < intervals[i].first);
+			sorted.push_back(intervals[i].first);
+			lasts.push_back(intervals[i].last);
+			values.push_back(std::move(intervals[i].value));
+		}
+
+		if (Layout == interval_layout::eytzinger)
+		{
+			starts.resize(sorted.size() + 1);
+			ranks.resize(sorted.size() + 1);
+			build_eytzinger(sorted, 0, 1);
+		}
+		else
+		{
+			starts = std::move(sorted);
+		}
+	}
+
+	size_t size() const { return lasts.size(); }
+	const Key& last(size_t index) const { return lasts[index]; }
+	const Value& value(size_t index) const { return values[index]; }
+
+	// The sorted position of the interval containing x, or npos.
+
+	size_t find_index(const Key& x) const
+	{
+		return verify(predecessor(x), x);
+	}
+
+	const Value* find(const Key& x) const
+	{
+		const size_t index = find_index(x);
+		return index == npos ? nullptr : &values[index];
+	}
+
+	// Looks up count keys, writing the sorted position of each containing
+	// interval, or npos, to out. The searches run interleaved with prefetching.
+
+	void find_batch(const Key* keys, size_t count, size_t* out) const
+	{
+		if (Layout == interval_layout::eytzinger)
+		{
+			constexpr size_t width = monobound_batch_width;
+			size_t k[width];
+
+			for (size_t base = 0; base < count; base += width)
+			{
+				const size_t group = count - base < width ? count - base : width;
+				bool pending = true;
+
+				for (size_t j = 0; j != group; ++j)
+					k[j] = 1;
+
+				while (pending)
+				{
+					pending = false;
+					for (size_t j = 0; j != group; ++j)
+					{
+						if (k[j] < starts.size())
+						{
+							k[j] = 2 * k[j] + !(keys[base + j] < starts[k[j]]);
+							if (k[j] < starts.size())
+							{
+								BINARY_SEARCH_PREFETCH(&starts[k[j]]);
+								pending = true;
+							}
+						}
+					}
+				}
+
+				for (size_t j = 0; j != group; ++j)
+				{
+					const size_t node = k[j] >> (trailing_ones(k[j]) + 1);
+					out[base + j] = verify((node ? ranks[node] : lasts.size()) - 1, keys[base + j]);
+				}
+			}
+		}
+		else
+		{
+			typename std::vector<Key>::const_iterator found[monobound_batch_width];
+
+			for (size_t base = 0; base < count; base += monobound_batch_width)
+			{
+				const size_t group = count - base < monobound_batch_width ? count - base : monobound_batch_width;
+
+				::monobound_batch_search_base(starts.begin(), starts.end(), keys + base, keys + base + group, found,
+					[](auto& key, auto& right) { return key < right; },
+					[](auto& key, auto& right) { return !(key < right); });
+
+				for (size_t j = 0; j != group; ++j)
+					out[base + j] = found[j] == starts.end() ? npos : verify((size_t)(found[j] - starts.begin()), keys[base + j]);
+			}
+		}
+	}
+};
+
+#endif
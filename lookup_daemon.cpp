@@ -0,0 +1,574 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+*/
+
+/*
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Lookup daemon v1.0
+
+	A single server process holds a sorted index of 64 bit keys. Clients map a
+	shared memory ring, claim a slot, fill it with up to LOOKUP_BATCH keys and
+	wait. The server answers every slot with monobound_batch_search() and
+	writes the resulting indices (or -1) over the keys in place. While
+	requests keep coming neither side makes a system call; a side that has
+	waited a while yields or naps (see relax()).
+
+	A client only touches a slot's keys while the slot's sequence says it owns
+	them. A ticket that a client takes but never turns into a claim, or an
+	answer it never collects, holds the ring up for at most LOOKUP_TIMEOUT
+	before the server frees the slot. A client that was merely slow finds its
+	claim refused and retries, or reports its batch as dropped. Once the
+	server is stopped, waiting clients give up instead of spinning.
+
+	Compile using: g++ -O3 -std=c++17 lookup_daemon.cpp -o lookup_daemon -lrt
+
+	Usage: lookup_daemon serve <name> [<items>|<sorted int64 file>]
+	       lookup_daemon query <name> <key> [<key> ...]
+	       lookup_daemon bench <name> [batches] [seed]
+	       lookup_daemon stop  <name>
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <stdint.h>
+#include <time.h>
+#include <sched.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <atomic>
+#include <new>
+#include <vector>
+#include <algorithm>
+#include <plf_nanotimer_c_api.h>
+#include "binary_search.hpp"
+
+#define LOOKUP_MAGIC   0x4b4f4f4c5342ULL // "BSLOOK"
+#define LOOKUP_BATCH   256
+#define LOOKUP_SLOTS   64                // power of two, at least 8
+#define LOOKUP_TIMEOUT 1000000000LL      // ns a stalled slot may hold up the ring
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free, "the ring needs address free atomics");
+static_assert((LOOKUP_SLOTS & (LOOKUP_SLOTS - 1)) == 0 && LOOKUP_SLOTS >= 8, "LOOKUP_SLOTS must be a power of two >= 8");
+
+// A slot cycles through these sequence values per lap, where pos is the
+// ticket a client took from head: pos (free), pos + 1 (filling), pos + 2
+// (submitted), pos + 3 (answered) and pos + 4 (collecting). The client frees
+// it again by storing pos + LOOKUP_SLOTS. A client enters filling and
+// collecting with a compare and swap, so it never touches data in a slot the
+// server has reclaimed; the server only reclaims free and answered slots.
+
+struct lookup_slot
+{
+	alignas(64) std::atomic<uint64_t> sequence;
+	uint32_t count;
+	int64_t data[LOOKUP_BATCH];
+};
+
+struct lookup_ring
+{
+	std::atomic<uint64_t> magic;
+	std::atomic<uint32_t> running;
+	int64_t items, min_key, max_key;
+
+	alignas(64) std::atomic<uint64_t> head;
+
+	lookup_slot slots[LOOKUP_SLOTS];
+};
+
+static void relax(unsigned int *spins)
+{
+	if (++*spins < 64)
+	{
+#if defined(__x86_64__) || defined(__i386__)
+		__builtin_ia32_pause();
+#endif
+	}
+	else if (*spins < 4096)
+	{
+		sched_yield();
+	}
+	else
+	{
+		struct timespec nap = { 0, 50000 };
+
+		nanosleep(&nap, NULL);
+	}
+}
+
+static long long monotonic_ns(void)
+{
+	struct timespec now;
+
+	clock_gettime(CLOCK_MONOTONIC, &now);
+
+	return now.tv_sec * 1000000000LL + now.tv_nsec;
+}
+
+static lookup_ring *ring_map(const char *name, int create)
+{
+	char path[256];
+	int fd;
+	void *map;
+
+	snprintf(path, sizeof(path), "/%s", name);
+
+	fd = create ? shm_open(path, O_CREAT | O_EXCL | O_RDWR, 0600) : shm_open(path, O_RDWR, 0);
+
+	if (fd < 0)
+	{
+		perror(path);
+		return NULL;
+	}
+
+	if (create && ftruncate(fd, sizeof(lookup_ring)) != 0)
+	{
+		perror("ftruncate");
+		close(fd);
+		shm_unlink(path);
+		return NULL;
+	}
+
+	map = mmap(NULL, sizeof(lookup_ring), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+
+	close(fd);
+
+	if (map == MAP_FAILED)
+	{
+		perror("mmap");
+		return NULL;
+	}
+
+	if (create)
+	{
+		lookup_ring *ring = new (map) lookup_ring;
+
+		for (uint64_t cnt = 0 ; cnt < LOOKUP_SLOTS ; cnt++)
+		{
+			ring->slots[cnt].sequence.store(cnt, std::memory_order_relaxed);
+		}
+		ring->head.store(0, std::memory_order_relaxed);
+		ring->running.store(1, std::memory_order_relaxed);
+		ring->magic.store(0, std::memory_order_relaxed);
+
+		return ring;
+	}
+
+	lookup_ring *ring = (lookup_ring *) map;
+
+	if (ring->magic.load(std::memory_order_acquire) != LOOKUP_MAGIC)
+	{
+		fprintf(stderr, "%s: not a lookup ring, or the server is still starting\n", path);
+		munmap(map, sizeof(lookup_ring));
+		return NULL;
+	}
+
+	if (!ring->running.load(std::memory_order_acquire))
+	{
+		fprintf(stderr, "%s: the server has stopped\n", path);
+		munmap(map, sizeof(lookup_ring));
+		return NULL;
+	}
+	return ring;
+}
+
+// client side
+
+// Returns 0 and the claimed ticket in *ticket, or -1 if the server stopped.
+
+static int ring_submit(lookup_ring *ring, const int64_t *keys, uint32_t count, uint64_t *ticket)
+{
+	unsigned int spins = 0;
+	uint64_t pos = ring->head.load(std::memory_order_relaxed);
+	lookup_slot *slot;
+
+	while (1)
+	{
+		slot = &ring->slots[pos & (LOOKUP_SLOTS - 1)];
+
+		int64_t diff = (int64_t) (slot->sequence.load(std::memory_order_acquire) - pos);
+
+		if (diff == 0)
+		{
+			if (ring->head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+			{
+				uint64_t expected = pos;
+
+				if (slot->sequence.compare_exchange_strong(expected, pos + 1, std::memory_order_acquire, std::memory_order_relaxed))
+				{
+					memcpy(slot->data, keys, count * sizeof(int64_t));
+					slot->count = count;
+					slot->sequence.store(pos + 2, std::memory_order_release);
+
+					*ticket = pos;
+
+					return 0;
+				}
+				// the server reclaimed the ticket before it was claimed
+
+				pos = ring->head.load(std::memory_order_relaxed);
+			}
+		}
+		else if (diff < 0)
+		{
+			if (!ring->running.load(std::memory_order_relaxed))
+			{
+				return -1;
+			}
+			relax(&spins);
+			pos = ring->head.load(std::memory_order_relaxed);
+		}
+		else
+		{
+			pos = ring->head.load(std::memory_order_relaxed);
+		}
+	}
+}
+
+// Returns 0, or -1 if the server stopped or reclaimed the answer first.
+
+static int ring_collect(lookup_ring *ring, uint64_t pos, int64_t *results)
+{
+	unsigned int spins = 0;
+	lookup_slot *slot = &ring->slots[pos & (LOOKUP_SLOTS - 1)];
+
+	while (1)
+	{
+		uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+
+		if (sequence == pos + 3)
+		{
+			if (slot->sequence.compare_exchange_strong(sequence, pos + 4, std::memory_order_acquire, std::memory_order_relaxed))
+			{
+				break;
+			}
+			return -1;
+		}
+
+		if ((int64_t) (sequence - pos) > 3 || !ring->running.load(std::memory_order_relaxed))
+		{
+			return -1;
+		}
+		relax(&spins);
+	}
+
+	uint32_t count = slot->count < LOOKUP_BATCH ? slot->count : LOOKUP_BATCH;
+
+	memcpy(results, slot->data, count * sizeof(int64_t));
+	slot->sequence.store(pos + LOOKUP_SLOTS, std::memory_order_release);
+
+	return 0;
+}
+
+// server side
+
+// Frees a slot that held the ring up for LOOKUP_TIMEOUT: one whose ticket a
+// client took but never claimed, or the previous lap's answer that was never
+// collected. Slots being filled or collected are left alone, since their
+// owner may still be writing or reading the data. Returns 1 if the server
+// should move on to the next slot.
+
+static int ring_reclaim(lookup_ring *ring, lookup_slot *slot, uint64_t pos, uint64_t sequence)
+{
+	if (sequence == pos && ring->head.load(std::memory_order_relaxed) > pos)
+	{
+		return slot->sequence.compare_exchange_strong(sequence, pos + LOOKUP_SLOTS, std::memory_order_relaxed);
+	}
+
+	if (sequence == pos + 3 - LOOKUP_SLOTS)
+	{
+		slot->sequence.compare_exchange_strong(sequence, pos, std::memory_order_relaxed);
+	}
+	return 0;
+}
+
+static int serve(const char *name, const char *source)
+{
+	std::vector<int64_t> index;
+	lookup_ring *ring;
+	char *end;
+
+	long long items = strtoll(source, &end, 10);
+
+	if (*end == 0)
+	{
+		int64_t val = 0;
+
+		if (items < 0 || (unsigned long long) items > index.max_size())
+		{
+			fprintf(stderr, "%s: the item count must be between 0 and %zu\n", source, index.max_size());
+			return 1;
+		}
+
+		index.resize(items);
+
+		srand(time(NULL));
+
+		for (auto& key : index)
+		{
+			key = (val += rand() % 20);
+		}
+	}
+	else
+	{
+		FILE *fp = fopen(source, "rb");
+		int64_t key;
+
+		if (fp == NULL)
+		{
+			perror(source);
+			return 1;
+		}
+
+		while (fread(&key, sizeof(key), 1, fp) == 1)
+		{
+			index.push_back(key);
+		}
+		fclose(fp);
+
+		if (!std::is_sorted(index.begin(), index.end()))
+		{
+			fprintf(stderr, "%s: keys are not sorted\n", source);
+			return 1;
+		}
+	}
+
+	ring = ring_map(name, 1);
+
+	if (ring == NULL)
+	{
+		return 1;
+	}
+
+	ring->items = index.size();
+	ring->min_key = index.empty() ? 0 : index.front();
+	ring->max_key = index.empty() ? 0 : index.back();
+
+	ring->magic.store(LOOKUP_MAGIC, std::memory_order_release);
+
+	printf("serving %zu keys on /%s\n", index.size(), name);
+
+	fflush(stdout);
+
+	std::vector<int64_t>::iterator found[LOOKUP_BATCH];
+	uint64_t pos = 0, stalled = pos + 2;
+	unsigned int spins = 0;
+	long long since = 0;
+
+	while (ring->running.load(std::memory_order_relaxed))
+	{
+		lookup_slot *slot = &ring->slots[pos & (LOOKUP_SLOTS - 1)];
+		uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+
+		if (sequence != pos + 2)
+		{
+			relax(&spins);
+
+			// only look at the clock once relax() has started to sleep
+
+			if (spins >= 4096)
+			{
+				if (sequence != stalled)
+				{
+					stalled = sequence;
+					since = monotonic_ns();
+				}
+				else if (monotonic_ns() - since >= LOOKUP_TIMEOUT)
+				{
+					pos += ring_reclaim(ring, slot, pos, sequence);
+					stalled = pos + 2;
+				}
+			}
+			continue;
+		}
+		spins = 0;
+
+		uint32_t count = slot->count < LOOKUP_BATCH ? slot->count : LOOKUP_BATCH;
+
+		monobound_batch_search(index.begin(), index.end(), slot->data, slot->data + count, found);
+
+		for (uint32_t cnt = 0 ; cnt < count ; cnt++)
+		{
+			slot->data[cnt] = found[cnt] == index.end() ? -1 : found[cnt] - index.begin();
+		}
+
+		slot->sequence.store(pos + 3, std::memory_order_release);
+
+		pos++;
+		stalled = pos + 2;
+	}
+
+	char path[256];
+
+	snprintf(path, sizeof(path), "/%s", name);
+
+	shm_unlink(path);
+	munmap(ring, sizeof(lookup_ring));
+
+	printf("stopped after %llu batches\n", (unsigned long long) pos);
+
+	return 0;
+}
+
+static int query(const char *name, int argc, char **argv)
+{
+	lookup_ring *ring = ring_map(name, 0);
+	int64_t keys[LOOKUP_BATCH];
+
+	if (ring == NULL)
+	{
+		return 1;
+	}
+
+	while (argc > 0)
+	{
+		uint32_t count = argc < LOOKUP_BATCH ? argc : LOOKUP_BATCH;
+
+		for (uint32_t cnt = 0 ; cnt < count ; cnt++)
+		{
+			keys[cnt] = strtoll(argv[cnt], NULL, 10);
+		}
+
+		uint64_t pos;
+
+		if (ring_submit(ring, keys, count, &pos) || ring_collect(ring, pos, keys))
+		{
+			fprintf(stderr, "/%s: the server stopped or dropped the batch\n", name);
+			munmap(ring, sizeof(lookup_ring));
+			return 1;
+		}
+
+		for (uint32_t cnt = 0 ; cnt < count ; cnt++)
+		{
+			printf("%s %lld\n", argv[cnt], (long long) keys[cnt]);
+		}
+		argc -= count;
+		argv += count;
+	}
+	munmap(ring, sizeof(lookup_ring));
+
+	return 0;
+}
+
+static int bench(const char *name, int batches, int rnd)
+{
+	lookup_ring *ring = ring_map(name, 0);
+	int64_t keys[LOOKUP_BATCH];
+	unsigned int hit = 0, miss = 0;
+	nanotimer_data_t timer;
+
+	if (ring == NULL)
+	{
+		return 1;
+	}
+
+	uint64_t span = (uint64_t) ring->max_key - (uint64_t) ring->min_key + 20;
+
+	srand(rnd);
+
+	nanotimer(&timer);
+	nanotimer_start(&timer);
+
+	for (int batch = 0 ; batch < batches ; batch++)
+	{
+		for (int cnt = 0 ; cnt < LOOKUP_BATCH ; cnt++)
+		{
+			keys[cnt] = (int64_t) ((uint64_t) ring->min_key + ((uint64_t) rand() << 31 | rand()) % span);
+		}
+
+		uint64_t pos;
+
+		if (ring_submit(ring, keys, LOOKUP_BATCH, &pos) || ring_collect(ring, pos, keys))
+		{
+			fprintf(stderr, "/%s: the server stopped or dropped the batch\n", name);
+			munmap(ring, sizeof(lookup_ring));
+			return 1;
+		}
+
+		for (int cnt = 0 ; cnt < LOOKUP_BATCH ; cnt++)
+		{
+			if (keys[cnt] >= 0)
+			{
+				hit++;
+			}
+			else
+			{
+				miss++;
+			}
+		}
+	}
+
+	double duration = nanotimer_get_elapsed_us(&timer);
+
+	printf("| %10s | %10s | %10s | %10s | %10s |\n", "Items", "Batches", "Hits", "Misses", "Time");
+	printf("| %10s | %10s | %10s | %10s | %10s |\n", "----------", "----------", "----------", "----------", "----------");
+	printf("| %10lld | %10d | %10d | %10d | %10f |\n", (long long) ring->items, batches, hit, miss, duration / 1000000.0);
+
+	munmap(ring, sizeof(lookup_ring));
+
+	return 0;
+}
+
+int main(int argc, char **argv)
+{
+	if (argc < 3)
+	{
+		fprintf(stderr, "usage: %s serve|query|bench|stop <name> ...\n", argv[0]);
+		return 1;
+	}
+
+	if (!strcmp(argv[1], "serve"))
+	{
+		return serve(argv[2], argc > 3 ? argv[3] : "1000000");
+	}
+
+	if (!strcmp(argv[1], "query"))
+	{
+		return query(argv[2], argc - 3, argv + 3);
+	}
+
+	if (!strcmp(argv[1], "bench"))
+	{
+		return bench(argv[2], argc > 3 ? atoi(argv[3]) : 10000, argc > 4 ? atoi(argv[4]) : time(NULL));
+	}
+
+	if (!strcmp(argv[1], "stop"))
+	{
+		lookup_ring *ring = ring_map(argv[2], 0);
+
+		if (ring == NULL)
+		{
+			return 1;
+		}
+		ring->running.store(0, std::memory_order_release);
+		munmap(ring, sizeof(lookup_ring));
+
+		return 0;
+	}
+
+	fprintf(stderr, "%s: unknown command '%s'\n", argv[0], argv[1]);
+
+	return 1;
+}
@@ -0,0 +1,318 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MORTON_INDEX_HPP
+#define MORTON_INDEX_HPP
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include "binary_search.hpp"
+
+
+
+// x occupies the even bits of a Morton code, y the odd bits.
+
+constexpr uint64_t morton_spread(uint32_t value)
+{
+	uint64_t v = value;
+	v = (v | v << 16) & 0x0000FFFF0000FFFFULL;
+	v = (v | v << 8) & 0x00FF00FF00FF00FFULL;
+	v = (v | v << 4) & 0x0F0F0F0F0F0F0F0FULL;
+	v = (v | v << 2) & 0x3333333333333333ULL;
+	v = (v | v << 1) & 0x5555555555555555ULL;
+	return v;
+}
+
+constexpr uint32_t morton_compact(uint64_t v)
+{
+	v &= 0x5555555555555555ULL;
+	v = (v | v >> 1) & 0x3333333333333333ULL;
+	v = (v | v >> 2) & 0x0F0F0F0F0F0F0F0FULL;
+	v = (v | v >> 4) & 0x00FF00FF00FF00FFULL;
+	v = (v | v >> 8) & 0x0000FFFF0000FFFFULL;
+	v = (v | v >> 16) & 0x00000000FFFFFFFFULL;
+	return (uint32_t)v;
+}
+
+constexpr uint64_t morton_encode(uint32_t x, uint32_t y)
+{
+	return morton_spread(x) | morton_spread(y) << 1;
+}
+
+constexpr uint32_t morton_x(uint64_t code) { return morton_compact(code); }
+constexpr uint32_t morton_y(uint64_t code) { return morton_compact(code >> 1); }
+
+// An inclusive bounding box.
+
+struct morton_box
+{
+	uint32_t x0, y0, x1, y1;
+
+	constexpr bool contains(uint64_t code) const
+	{
+		const uint32_t x = morton_x(code), y = morton_y(code);
+		return x >= x0 && x <= x1 && y >= y0 && y <= y1;
+	}
+};
+
+// The smallest code above code that lies inside the box spanned by zmin and
+// zmax (Tropf and Herzog), or code itself when there is none. litmax is the
+// mirror image: the largest code below code inside the box.
+
+constexpr uint64_t morton_bigmin(uint64_t code, uint64_t zmin, uint64_t zmax)
+{
+	uint64_t bigmin = code;
+
+	for (int bit = 63; bit >= 0; --bit)
+	{
+		const uint64_t mask = 1ULL << bit;
+		const uint64_t lower = (bit & 1 ? 0xAAAAAAAAAAAAAAAAULL : 0x5555555555555555ULL) & (mask - 1);
+		const int state = (code & mask ? 4 : 0) | (zmin & mask ? 2 : 0) | (zmax & mask ? 1 : 0);
+
+		switch (state)
+		{
+			case 1:
+				bigmin = (zmin | mask) & ~lower;
+				zmax = (zmax & ~mask) | lower;
+				break;
+			case 3:
+				return zmin;
+			case 4:
+				return bigmin;
+			case 5:
+				zmin = (zmin | mask) & ~lower;
+				break;
+		}
+	}
+	return bigmin;
+}
+
+constexpr uint64_t morton_litmax(uint64_t code, uint64_t zmin, uint64_t zmax)
+{
+	uint64_t litmax = code;
+
+	for (int bit = 63; bit >= 0; --bit)
+	{
+		const uint64_t mask = 1ULL << bit;
+		const uint64_t lower = (bit & 1 ? 0xAAAAAAAAAAAAAAAAULL : 0x5555555555555555ULL) & (mask - 1);
+		const int state = (code & mask ? 4 : 0) | (zmin & mask ? 2 : 0) | (zmax & mask ? 1 : 0);
+
+		switch (state)
+		{
+			case 1:
+				zmax = (zmax & ~mask) | lower;
+				break;
+			case 3:
+				return litmax;
+			case 4:
+				return zmax;
+			case 5:
+				litmax = (zmax & ~mask) | lower;
+				zmin = (zmin | mask) & ~lower;
+				break;
+		}
+	}
+	return litmax;
+}
+
+// Box queries on a sorted array of Morton codes. A box is first decomposed
+// into at most max_ranges contiguous Z-order ranges, whose start positions are
+// found together with monobound_batch_search(). Ranges that lie completely
+// inside the box are copied out; in the others every run of jump_threshold
+// codes outside the box is skipped by galloping to the next BIGMIN. The index
+// does not own the array.
+
+class morton_index
+{
+	const uint64_t* array;
+	size_t size;
+
+	struct range
+	{
+		uint64_t first, last;
+		bool partial;
+	};
+
+	static constexpr size_t jump_threshold = 4;
+
+	// The first position at or after from whose code is >= key.
+
+	size_t gallop(uint64_t key, size_t from) const
+	{
+		size_t bot = from, top = 1;
+
+		if (bot >= size || array[bot] >= key)
+			return bot;
+
+		while (true)
+		{
+			if (bot + top >= size)
+			{
+				top = size - bot;
+				break;
+			}
+			if (array[bot + top] >= key)
+				break;
+			bot += top;
+			top *= 2;
+		}
+
+		while (top > 1)
+		{
+			const size_t mid = top / 2;
+			if (array[bot + mid] < key)
+				bot += mid;
+			top -= mid;
+		}
+		return bot + 1;
+	}
+
+	static std::vector<range> decompose(const morton_box& box, size_t max_ranges)
+	{
+		struct cell
+		{
+			uint64_t code;
+			unsigned level;
+			bool partial;
+		};
+
+		auto classify = [&](uint64_t code, unsigned level, std::vector<cell>& cells)
+		{
+			const uint64_t side = (1ULL << level) - 1;
+			const uint64_t x = morton_x(code), y = morton_y(code);
+
+			if (x > box.x1 || y > box.y1 || x + side < box.x0 || y + side < box.y0)
+				return;
+			cells.push_back({ code, level, x < box.x0 || y < box.y0 || x + side > box.x1 || y + side > box.y1 });
+		};
+
+		auto merge = [](const std::vector<cell>& cells)
+		{
+			std::vector<range> ranges;
+
+			for (const cell& c : cells)
+			{
+				const uint64_t last = c.level == 32 ? UINT64_MAX : c.code + ((1ULL << 2 * c.level) - 1);
+
+				if (!ranges.empty() && ranges.back().last + 1 == c.code && ranges.back().partial == c.partial)
+					ranges.back().last = last;
+				else
+					ranges.push_back({ c.code, last, c.partial });
+			}
+			return ranges;
+		};
+
+		std::vector<cell> cells = { { 0, 32, true } }, next;
+		std::vector<range> ranges = merge(cells);
+
+		for (unsigned level = 32; level-- > 0; )
+		{
+			bool refined = false;
+			next.clear();
+
+			for (const cell& c : cells)
+			{
+				if (!c.partial)
+				{
+					next.push_back(c);
+					continue;
+				}
+				for (uint64_t quadrant = 0; quadrant != 4; ++quadrant)
+					classify(c.code | quadrant << 2 * level, level, next);
+				refined = true;
+			}
+
+			std::vector<range> candidate = merge(next);
+
+			if (!refined || candidate.size() > max_ranges)
+				break;
+			cells.swap(next);
+			ranges.swap(candidate);
+		}
+		return ranges;
+	}
+
+public:
+	static constexpr size_t max_ranges = monobound_batch_width;
+
+	constexpr morton_index(const uint64_t* array, size_t size)
+		: array(array), size(size)
+	{
+	}
+
+	// Writes the position of every code inside the box to out, in ascending order.
+
+	template <typename OutputIterator>
+	OutputIterator query(const morton_box& box, OutputIterator out) const
+	{
+		if (size == 0 || box.x0 > box.x1 || box.y0 > box.y1)
+			return out;
+
+		const uint64_t zmin = morton_encode(box.x0, box.y0);
+		const uint64_t zmax = morton_encode(box.x1, box.y1);
+		const std::vector<range> ranges = decompose(box, max_ranges);
+		uint64_t starts[max_ranges];
+		const uint64_t* found[max_ranges];
+
+		for (size_t r = 0; r != ranges.size(); ++r)
+			starts[r] = ranges[r].first;
+
+		// rightmost code < start, so the range begins one past it
+
+		::monobound_batch_search_base(array, array + size, starts, starts + ranges.size(), found,
+			[](uint64_t key, uint64_t right) { return key <= right; },
+			[](uint64_t key, uint64_t right) { return right < key; });
+
+		for (size_t r = 0; r != ranges.size(); ++r)
+		{
+			size_t pos = found[r] == array + size ? 0 : (size_t)(found[r] - array) + 1;
+			size_t misses = 0;
+
+			while (pos < size && array[pos] <= ranges[r].last)
+			{
+				const uint64_t code = array[pos];
+
+				if (!ranges[r].partial || box.contains(code))
+				{
+					*out++ = pos++;
+					misses = 0;
+				}
+				else if (++misses < jump_threshold)
+				{
+					++pos;
+				}
+				else
+				{
+					const uint64_t next = morton_bigmin(code, zmin, zmax);
+
+					if (next <= code || next > ranges[r].last)
+						break;
+					pos = gallop(next, pos + 1);
+					misses = 0;
+				}
+			}
+		}
+		return out;
+	}
+};
+
+#endif
@@ -0,0 +1,163 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MULTI_SELECT_HPP
+#define MULTI_SELECT_HPP
+#include <vector>
+#include <future>
+#include <algorithm>
+#include <stdexcept>
+#include <cstddef>
+#include "binary_search.hpp"
+
+
+
+template <typename T>
+struct sorted_partition
+{
+	const T* data;
+	size_t size;
+};
+
+// Finds the k-th smallest element (counting from 0) across several sorted
+// partitions without merging them. Each partition keeps an active window.
+// Every round takes the median of each window, picks the median of those
+// medians weighted by window size as the pivot, and counts the elements below
+// and at the pivot in every window with monobound searches. Depending on where
+// k falls, either everything from the pivot up or everything up to the pivot
+// is discarded, at least a quarter of the remaining elements each round.
+//
+// With threads > 1 the per-partition searches of a round are spread over that
+// many tasks. Each task is a std::async call, which starts a new thread every
+// round, so threads only pay off when the partitions are large or many. If
+// splits is given, splits[i] receives how many elements of partition i precede
+// the k-th element, with ties broken by partition order, so the splits sum to
+// k. Throws std::out_of_range if k is not below the total number of elements.
+
+template <typename T>
+T multi_select(const sorted_partition<T>* parts, size_t count, size_t k, size_t* splits = nullptr, unsigned threads = 1)
+{
+	std::vector<size_t> low(count, 0), high(count), below(count), upto(count);
+	std::vector<std::pair<T, size_t>> medians;
+
+	size_t total = 0;
+
+	for (size_t i = 0; i != count; ++i)
+		total += high[i] = parts[i].size;
+
+	if (k >= total)
+		throw std::out_of_range("multi_select: k is not below the number of elements");
+
+	auto for_each_partition = [&](auto&& body)
+	{
+		if (threads <= 1 || count < 2 * (size_t)threads)
+		{
+			for (size_t i = 0; i != count; ++i)
+				body(i);
+			return;
+		}
+
+		std::vector<std::future<void>> tasks;
+		const size_t chunk = (count + threads - 1) / threads;
+
+		for (size_t first = 0; first < count; first += chunk)
+		{
+			tasks.push_back(std::async(std::launch::async, [&, first]
+			{
+				for (size_t i = first; i < first + chunk && i < count; ++i)
+					body(i);
+			}));
+		}
+		for (auto& task : tasks)
+			task.wait();
+	};
+
+	while (true)
+	{
+		size_t remaining = 0;
+		medians.clear();
+
+		for (size_t i = 0; i != count; ++i)
+		{
+			if (low[i] != high[i])
+			{
+				medians.emplace_back(parts[i].data[low[i] + (high[i] - low[i]) / 2], high[i] - low[i]);
+				remaining += high[i] - low[i];
+			}
+		}
+		assert(k < remaining);
+
+		std::sort(medians.begin(), medians.end(),
+			[](const std::pair<T, size_t>& left, const std::pair<T, size_t>& right) { return left.first < right.first; });
+
+		size_t weight = 0;
+		auto pivot = medians.begin();
+		while ((weight += pivot->second) * 2 < remaining)
+			++pivot;
+		const T value = pivot->first;
+
+		for_each_partition([&](size_t i)
+		{
+			const T* first = parts[i].data + low[i];
+			const T* last = parts[i].data + high[i];
+
+			below[i] = ::monobound_partition_point(first, last, [&](const T& x) { return x < value; }) - first;
+			upto[i] = ::monobound_partition_point(first + below[i], last, [&](const T& x) { return !(value < x); }) - first;
+		});
+
+		size_t less = 0, equal = 0;
+
+		for (size_t i = 0; i != count; ++i)
+		{
+			less += below[i];
+			equal += upto[i] - below[i];
+		}
+
+		if (k < less)
+		{
+			for (size_t i = 0; i != count; ++i)
+				high[i] = low[i] + below[i];
+		}
+		else if (k < less + equal)
+		{
+			if (splits != nullptr)
+			{
+				k -= less;
+				for (size_t i = 0; i != count; ++i)
+				{
+					const size_t take = std::min(k, upto[i] - below[i]);
+					splits[i] = low[i] + below[i] + take;
+					k -= take;
+				}
+			}
+			return value;
+		}
+		else
+		{
+			k -= less + equal;
+			for (size_t i = 0; i != count; ++i)
+				low[i] += upto[i];
+		}
+	}
+}
+
+#endif
@@ -0,0 +1,131 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef MVCC_LOOKUP_HPP
+#define MVCC_LOOKUP_HPP
+#include <cstddef>
+#include "binary_search.hpp"
+
+
+
+// Point reads on a flat array of versions sorted by (key, timestamp): the
+// newest version of key that is not newer than the read timestamp. The first
+// phase is a monobound search on the key alone, which lands on the newest
+// version of the key. Most reads want a recent version, so the second phase
+// checks that version and otherwise gallops backwards through the key's run
+// before a monobound search on the timestamp finishes the job. Returns end
+// when the key has no version at or before the timestamp.
+
+template <typename Iterator, typename Key, typename Time, typename KeyOf, typename TimeOf>
+constexpr Iterator mvcc_resolve(Iterator begin, Iterator end, Iterator newest, const Key& key, const Time& ts, KeyOf&& key_of, TimeOf&& time_of)
+{
+	if (newest == end || !(key_of(*newest) == key))
+		return end;
+	if (!(ts < time_of(*newest)))
+		return newest;
+
+	auto visible = [&](auto& entry) { return key_of(entry) < key || !(ts < time_of(entry)); };
+	auto bot = std::distance(begin, newest);
+	decltype(bot) top = 1;
+
+	while (true)
+	{
+		if (bot < top)
+		{
+			top = bot;
+			bot = 0;
+			break;
+		}
+		bot -= top;
+		if (visible(*std::next(begin, bot)))
+			break;
+		top *= 2;
+	}
+
+	while (top > 1)
+	{
+		auto mid = top / 2;
+		if (visible(*std::next(begin, bot + mid)))
+			bot += mid;
+		top -= mid;
+	}
+
+	Iterator target = std::next(begin, bot);
+	return key_of(*target) == key && !(ts < time_of(*target)) ? target : end;
+}
+
+template <typename Iterator, typename Key, typename Time, typename KeyOf, typename TimeOf>
+constexpr Iterator mvcc_lookup(Iterator begin, Iterator end, const Key& key, const Time& ts, KeyOf&& key_of, TimeOf&& time_of)
+{
+	Iterator newest = ::monobound_binary_search_base(begin, end,
+		[&](auto& right) { return key < key_of(right); },
+		[&](auto& right) { return key_of(right) == key; });
+
+	return ::mvcc_resolve(begin, end, newest, key, ts, key_of, time_of);
+}
+
+template <typename Iterator, typename Key, typename Time>
+constexpr Iterator mvcc_lookup(Iterator begin, Iterator end, const Key& key, const Time& ts)
+{
+	return ::mvcc_lookup(begin, end, key, ts,
+		[](auto& entry) -> auto& { return entry.key; },
+		[](auto& entry) -> auto& { return entry.timestamp; });
+}
+
+template <typename Collection, typename Key, typename Time>
+constexpr auto mvcc_lookup(Collection&& collection, const Key& key, const Time& ts)
+{
+	return ::mvcc_lookup(collection.begin(), collection.end(), key, ts);
+}
+
+// Batched point reads: out[i] receives the version of keys[i] visible at
+// timestamps[i], or end. The key phase of all reads runs through
+// monobound_batch_search(), so the cache misses of different reads overlap.
+
+template <typename Iterator, typename Key, typename Time, typename OutputIterator, typename KeyOf, typename TimeOf>
+OutputIterator mvcc_lookup_batch(Iterator begin, Iterator end, const Key* keys, const Time* timestamps, size_t count, OutputIterator out, KeyOf&& key_of, TimeOf&& time_of)
+{
+	Iterator newest[monobound_batch_width];
+
+	for (size_t base = 0; base < count; base += monobound_batch_width)
+	{
+		const size_t group = count - base < monobound_batch_width ? count - base : monobound_batch_width;
+
+		::monobound_batch_search_base(begin, end, keys + base, keys + base + group, newest,
+			[&](auto& key, auto& right) { return key < key_of(right); },
+			[&](auto& key, auto& right) { return key_of(right) == key; });
+
+		for (size_t j = 0; j != group; ++j)
+			*out++ = ::mvcc_resolve(begin, end, newest[j], keys[base + j], timestamps[base + j], key_of, time_of);
+	}
+	return out;
+}
+
+template <typename Iterator, typename Key, typename Time, typename OutputIterator>
+OutputIterator mvcc_lookup_batch(Iterator begin, Iterator end, const Key* keys, const Time* timestamps, size_t count, OutputIterator out)
+{
+	return ::mvcc_lookup_batch(begin, end, keys, timestamps, count, out,
+		[](auto& entry) -> auto& { return entry.key; },
+		[](auto& entry) -> auto& { return entry.timestamp; });
+}
+
+#endif
@@ -0,0 +1,208 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef PREDECESSOR_TRIE_HPP
+#define PREDECESSOR_TRIE_HPP
+#include <vector>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__GNUC__) || defined(__clang__)
+#define PREDECESSOR_POPCOUNT(word) __builtin_popcountll(word)
+#else
+#include <bitset>
+#define PREDECESSOR_POPCOUNT(word) std::bitset<64>(word).count()
+#endif
+
+
+
+// Predecessor queries on a sorted array of 32-bit keys. A key is split into
+// 11, 11 and 10 bits, which address a bitmap of the occupied top buckets, one
+// bitmap of occupied middle buckets per top bucket and one bitmap of present
+// keys per middle bucket. Every bitmap word carries the number of bits set in
+// the words before it and every node the number of distinct keys before it,
+// so the number of distinct keys <= key takes three popcounts and no search.
+// A missing bucket resolves to the node that follows it, and a sentinel node
+// and leaf terminate both levels.
+//
+// predecessor() returns the same index as the final position of
+// monobound_binary_search(): the rightmost element <= key, or npos when every
+// element is larger. A leaf takes 168 bytes, so the structure only pays off
+// when keys are dense enough to share leaves or queries vastly outnumber
+// updates. The array is not copied.
+
+class predecessor_trie
+{
+	struct node
+	{
+		uint32_t first_leaf;
+		uint16_t rank[32];
+		uint64_t bits[32];
+	};
+
+	struct leaf
+	{
+		uint32_t base;
+		uint16_t rank[16];
+		uint64_t bits[16];
+	};
+
+	uint16_t top_rank[32] = {};
+	uint64_t top_bits[32] = {};
+	std::vector<node> nodes;
+	std::vector<leaf> leaves;
+	std::vector<uint32_t> last;
+	size_t size = 0;
+
+	// Number of bits set below position in a rank annotated bitmap, and
+	// whether position itself is set.
+
+	template <typename Rank>
+	static size_t rank_below(const Rank* rank, const uint64_t* bits, uint32_t position, bool& present)
+	{
+		const uint64_t word = bits[position / 64];
+		const uint64_t mask = 1ULL << position % 64;
+
+		present = (word & mask) != 0;
+		return rank[position / 64] + PREDECESSOR_POPCOUNT(word & (mask - 1));
+	}
+
+	template <typename Rank, size_t Words>
+	static void annotate(Rank (&rank)[Words], const uint64_t (&bits)[Words])
+	{
+		Rank sum = 0;
+
+		for (size_t i = 0; i != Words; ++i)
+		{
+			rank[i] = sum;
+			sum += (Rank)PREDECESSOR_POPCOUNT(bits[i]);
+		}
+	}
+
+public:
+	static constexpr size_t npos = (size_t)-1;
+
+	predecessor_trie() = default;
+
+	predecessor_trie(const uint32_t* array, size_t size)
+		: size(size)
+	{
+		size_t distinct = 0;
+		bool duplicates = false;
+
+		assert(size < UINT32_MAX);
+
+		for (size_t i = 0; i != size; ++i)
+		{
+			const uint32_t key = array[i];
+
+			if (i != 0)
+			{
+				assert(array[i - 1] <= key);
+				if (array[i - 1] == key)
+				{
+					duplicates = true;
+					continue;
+				}
+			}
+
+			const uint32_t top = key >> 21, middle = key >> 10 & 0x7FF, low = key & 0x3FF;
+
+			if (nodes.empty() || (array[i - 1] >> 21) != top)
+			{
+				top_bits[top / 64] |= 1ULL << top % 64;
+				nodes.push_back({ (uint32_t)leaves.size(), {}, {} });
+			}
+			if (leaves.empty() || (array[i - 1] >> 10) != (key >> 10))
+			{
+				nodes.back().bits[middle / 64] |= 1ULL << middle % 64;
+				leaves.push_back({ (uint32_t)distinct, {}, {} });
+			}
+			leaves.back().bits[low / 64] |= 1ULL << low % 64;
+			++distinct;
+		}
+
+		// the number of distinct keys before a position maps back to the
+		// array only when every key is unique
+
+		if (duplicates)
+		{
+			last.reserve(distinct);
+			for (size_t i = 0; i != size; ++i)
+			{
+				if (i + 1 == size || array[i] != array[i + 1])
+					last.push_back((uint32_t)i);
+			}
+		}
+
+		annotate(top_rank, top_bits);
+		for (node& n : nodes)
+			annotate(n.rank, n.bits);
+		for (leaf& l : leaves)
+			annotate(l.rank, l.bits);
+
+		nodes.push_back({ (uint32_t)leaves.size(), {}, {} });
+		leaves.push_back({ (uint32_t)distinct, {}, {} });
+	}
+
+	// The number of distinct keys <= key.
+
+	size_t rank(uint32_t key) const
+	{
+		if (size == 0)
+			return 0;
+
+		bool present;
+		const size_t n = rank_below(top_rank, top_bits, key >> 21, present);
+
+		if (!present)
+			return leaves[nodes[n].first_leaf].base;
+
+		const node& parent = nodes[n];
+		const size_t l = parent.first_leaf + rank_below(parent.rank, parent.bits, key >> 10 & 0x7FF, present);
+
+		if (!present)
+			return leaves[l].base;
+
+		const leaf& child = leaves[l];
+		return child.base + rank_below(child.rank, child.bits, key & 0x3FF, present) + present;
+	}
+
+	size_t predecessor(uint32_t key) const
+	{
+		const size_t count = rank(key);
+
+		if (count == 0)
+			return npos;
+		return last.empty() ? count - 1 : last[count - 1];
+	}
+
+	// The total size of the bitmaps and rank tables in bytes.
+
+	size_t memory() const
+	{
+		return sizeof(*this) + nodes.size() * sizeof(node) + leaves.size() * sizeof(leaf) + last.size() * sizeof(uint32_t);
+	}
+};
+
+#endif
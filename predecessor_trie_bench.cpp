@@ -0,0 +1,151 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+*/
+
+/*
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Compares predecessor_trie against the monobound binary and quaternary
+	searches on random 32 bit keys. The Checksum column sums the returned
+	positions and should agree between all rows.
+
+	Compile using: g++ -O3 -march=native -std=c++17 predecessor_trie_bench.cpp
+
+	Usage: predecessor_trie_bench [items] [runs] [queries] [seed]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <random>
+#include <vector>
+#include <algorithm>
+#include <plf_nanotimer_c_api.h>
+#include "binary_search.hpp"
+#include "predecessor_trie.hpp"
+
+static std::vector<uint32_t> keys, queries;
+static long long max;
+static int runs, loop, rnd;
+
+template <typename Search>
+static void execute(Search&& search, const char *algo_name, size_t memory)
+{
+	nanotimer_data_t timer;
+	double best = 0;
+	unsigned long long checksum = 0;
+
+	nanotimer(&timer);
+
+	for (int run = runs ; run ; --run)
+	{
+		checksum = 0;
+
+		nanotimer_start(&timer);
+
+		for (uint32_t query : queries)
+		{
+			checksum += search(query);
+		}
+
+		double duration = nanotimer_get_elapsed_us(&timer);
+
+		if (best == 0 || duration < best)
+		{
+			best = duration;
+		}
+	}
+
+	printf("| %30s | %10lld | %10llu | %10zu | %10f | %10.1f |\n", algo_name, max, checksum, memory >> 20, best / 1000000.0, loop / best);
+}
+
+// Both searches end on the rightmost element <= query when the equality
+// check is replaced by <=.
+
+template <typename Iterator>
+static size_t position(Iterator found)
+{
+	return found == keys.end() ? predecessor_trie::npos : (size_t)(found - keys.begin());
+}
+
+int main(int argc, char **argv)
+{
+	max = 1000000;
+	runs = 10;
+	loop = 1000000;
+	rnd = time(NULL);
+
+	if (argc > 1)
+		max = atoll(argv[1]);
+
+	if (argc > 2)
+		runs = atoi(argv[2]);
+
+	if (argc > 3)
+		loop = atoi(argv[3]);
+
+	if (argc > 4)
+		rnd = atoi(argv[4]);
+
+	std::mt19937 gen(rnd);
+
+	keys.resize(max);
+	queries.resize(loop);
+
+	for (auto& key : keys)
+	{
+		key = gen();
+	}
+	std::sort(keys.begin(), keys.end());
+
+	for (auto& query : queries)
+	{
+		query = gen();
+	}
+
+	printf("Benchmark: keys: %lld, runs: %d, queries: %d, seed: %d\n\n", max, runs, loop, rnd);
+
+	printf("| %30s | %10s | %10s | %10s | %10s | %10s |\n", "Name", "Items", "Checksum", "MiB", "Time", "Mq/s");
+	printf("| %30s | %10s | %10s | %10s | %10s | %10s |\n", "----------", "----------", "----------", "----------", "----------", "----------");
+
+	const size_t array_memory = keys.size() * sizeof(uint32_t);
+
+	execute([](uint32_t query)
+	{
+		return position(::monobound_binary_search_base(keys.begin(), keys.end(),
+			[&](uint32_t right) { return query < right; },
+			[&](uint32_t right) { return right <= query; }));
+	}, "monobound_binary_search", array_memory);
+
+	execute([](uint32_t query)
+	{
+		return position(::monobound_quaternary_search_base(keys.begin(), keys.end(),
+			[&](uint32_t right) { return query < right; },
+			[&](uint32_t right) { return right <= query; }));
+	}, "monobound_quaternary_search", array_memory);
+
+	predecessor_trie trie(keys.data(), keys.size());
+
+	execute([&](uint32_t query) { return trie.predecessor(query); }, "predecessor_trie", trie.memory());
+
+	return 0;
+}
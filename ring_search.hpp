@@ -0,0 +1,131 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef RING_SEARCH_HPP
+#define RING_SEARCH_HPP
+#include <cstddef>
+#include "binary_search.hpp"
+
+
+
+// A sorted window in a circular buffer: count elements in logical order,
+// starting at base[head] and wrapping around at capacity. Since head < capacity
+// and every logical index is below capacity, a physical position never needs
+// more than one conditional subtract, which compiles to a cmov instead of the
+// division behind %.
+
+template <typename T>
+struct ring_view
+{
+	const T* base;
+	size_t capacity;
+	size_t head;
+	size_t count;
+
+	constexpr size_t physical(size_t index) const
+	{
+		const size_t position = head + index;
+		return position - (position >= capacity ? capacity : 0);
+	}
+
+	constexpr const T& operator[](size_t index) const { return base[physical(index)]; }
+	constexpr size_t size() const { return count; }
+};
+
+// Views a sorted array that was rotated by an unknown amount, for example
+// { 5, 7, 9, 1, 3 }, as a ring. The rotation point is found with a monobound
+// search, which requires that the first element does not appear again after
+// the wrap.
+
+template <typename T>
+constexpr ring_view<T> rotated_view(const T* array, size_t size)
+{
+	if (size == 0)
+		return { array, 0, 0, 0 };
+
+	const T* head = ::monobound_partition_point(array, array + size, [&](const T& x) { return !(x < array[0]); });
+	return { array, size, head == array + size ? 0 : (size_t)(head - array), size };
+}
+
+// The monobound search on logical indices. The loop has the same fixed shape
+// as monobound_binary_search_base() and translates each probe with physical(),
+// so the window is searched in place. Returns the logical index of the
+// rightmost match, or count.
+
+template <typename T, typename LessThan, typename Equal>
+constexpr size_t ring_binary_search(const ring_view<T>& ring, LessThan&& less_than, Equal&& equal_to)
+{
+	if (ring.count == 0)
+		return 0;
+
+	size_t bot = 0, top = ring.count;
+
+	while (top > 1)
+	{
+		const size_t mid = top / 2;
+		bot += less_than(ring[bot + mid]) ? 0 : mid;
+		top -= mid;
+	}
+	return equal_to(ring[bot]) ? bot : ring.count;
+}
+
+template <typename T, typename Key>
+constexpr size_t ring_binary_search(const ring_view<T>& ring, const Key& key)
+{
+	return ::ring_binary_search(ring,
+		[&](const T& right) { return key < right; },
+		[&](const T& right) { return key == right; });
+}
+
+// The logical index of the first element for which pred is false, with the
+// same preconditions as std::partition_point().
+
+template <typename T, typename Predicate>
+constexpr size_t ring_partition_point(const ring_view<T>& ring, Predicate&& pred)
+{
+	if (ring.count == 0)
+		return 0;
+
+	size_t bot = 0, top = ring.count;
+
+	while (top > 1)
+	{
+		const size_t mid = top / 2;
+		bot += pred(ring[bot + mid]) ? mid : 0;
+		top -= mid;
+	}
+	return pred(ring[bot]) ? bot + 1 : bot;
+}
+
+template <typename T, typename Key>
+constexpr size_t ring_lower_bound(const ring_view<T>& ring, const Key& key)
+{
+	return ::ring_partition_point(ring, [&](const T& x) { return x < key; });
+}
+
+template <typename T, typename Key>
+constexpr size_t ring_upper_bound(const ring_view<T>& ring, const Key& key)
+{
+	return ::ring_partition_point(ring, [&](const T& x) { return !(key < x); });
+}
+
+#endif
@@ -0,0 +1,190 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SEARCH_ARRAY_HPP
+#define SEARCH_ARRAY_HPP
+#include <new>
+#include <memory>
+#include <vector>
+#include <limits>
+#include <algorithm>
+#include <type_traits>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+
+
+// A sorted array of numbers laid out for searching. The storage is aligned to
+// a cache line and padded to a power of two of at least one cache line with
+// +infinity (or the largest value) as a sentinel, so the search never has to
+// look at the real size. The loop halves a power of two with shifts and
+// conditional adds until one aligned cache line is left, which is then
+// counted with full vector compares instead of being searched.
+
+template <typename T>
+class search_array
+{
+	static_assert(std::is_arithmetic<T>::value, "search_array needs a numeric type with a sentinel");
+
+	struct release
+	{
+		void operator()(T* pointer) const { ::operator delete(pointer, std::align_val_t(alignment)); }
+	};
+
+	std::unique_ptr<T, release> storage;
+	size_t length = 0;
+	size_t padded = 0;
+
+	// Counts the elements of the aligned line at line that are < key, or <= key
+	// with inclusive set. Since the line is sorted this is the insertion point
+	// of key within it.
+
+	template <bool inclusive>
+	static size_t count_line(const T* line, T key)
+	{
+#if defined(__AVX2__)
+		if constexpr (std::is_same<T, int32_t>::value)
+		{
+			const __m256i k = _mm256_set1_epi32((int32_t)key);
+			const __m256i a = _mm256_load_si256((const __m256i*)line);
+			const __m256i b = _mm256_load_si256((const __m256i*)line + 1);
+			const __m256i ga = inclusive ? _mm256_cmpgt_epi32(a, k) : _mm256_cmpgt_epi32(k, a);
+			const __m256i gb = inclusive ? _mm256_cmpgt_epi32(b, k) : _mm256_cmpgt_epi32(k, b);
+			const unsigned mask = (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(ga)) | (unsigned)_mm256_movemask_ps(_mm256_castsi256_ps(gb)) << 8;
+
+			// the greater than mask counts the elements after the insertion point
+
+			return inclusive ? line_size - popcount(mask) : popcount(mask);
+		}
+#elif defined(__SSE2__) || defined(_M_X64)
+		if constexpr (std::is_same<T, int32_t>::value)
+		{
+			const __m128i k = _mm_set1_epi32((int32_t)key);
+			unsigned mask = 0;
+
+			for (size_t j = 0; j != 4; ++j)
+			{
+				const __m128i v = _mm_load_si128((const __m128i*)line + j);
+				const __m128i g = inclusive ? _mm_cmpgt_epi32(v, k) : _mm_cmpgt_epi32(k, v);
+				mask |= (unsigned)_mm_movemask_ps(_mm_castsi128_ps(g)) << 4 * j;
+			}
+			return inclusive ? line_size - popcount(mask) : popcount(mask);
+		}
+#endif
+		size_t count = 0;
+
+		for (size_t j = 0; j != line_size; ++j)
+			count += inclusive ? !(key < line[j]) : line[j] < key;
+		return count;
+	}
+
+	static unsigned popcount(unsigned mask)
+	{
+#if defined(__GNUC__) || defined(__clang__)
+		return (unsigned)__builtin_popcount(mask);
+#else
+		unsigned count = 0;
+		for (; mask != 0; mask &= mask - 1)
+			++count;
+		return count;
+#endif
+	}
+
+	// The number of elements < key, or <= key with inclusive set, including
+	// sentinels.
+
+	template <bool inclusive>
+	size_t rank(T key) const
+	{
+		const T* array = storage.get();
+		size_t bot = 0;
+
+		for (size_t half = padded >> 1; half >= line_size; half >>= 1)
+			bot += (inclusive ? !(key < array[bot + half]) : array[bot + half] < key) ? half : 0;
+
+		return bot + count_line<inclusive>(array + bot, key);
+	}
+
+public:
+	static constexpr size_t alignment = 64;
+	static constexpr size_t line_size = sizeof(T) < alignment ? alignment / sizeof(T) : 1;
+	static constexpr size_t npos = (size_t)-1;
+
+	static constexpr T sentinel = std::numeric_limits<T>::has_infinity ? std::numeric_limits<T>::infinity() : std::numeric_limits<T>::max();
+
+	search_array()
+		: search_array(nullptr, 0)
+	{
+	}
+
+	search_array(const T* values, size_t size)
+		: length(size), padded(line_size)
+	{
+		while (padded < size)
+			padded *= 2;
+
+		storage.reset(static_cast<T*>(::operator new(padded * sizeof(T), std::align_val_t(alignment))));
+		std::copy(values, values + size, storage.get());
+		std::fill(storage.get() + size, storage.get() + padded, sentinel);
+
+		assert(std::is_sorted(values, values + size));
+	}
+
+	explicit search_array(const std::vector<T>& values)
+		: search_array(values.data(), values.size())
+	{
+	}
+
+	size_t size() const { return length; }
+	size_t capacity() const { return padded; }
+	const T* data() const { return storage.get(); }
+	const T& operator[](size_t index) const { return storage.get()[index]; }
+
+	// The first index whose element is not less than key, as std::lower_bound.
+
+	size_t lower_bound(T key) const
+	{
+		return std::min(rank<false>(key), length);
+	}
+
+	// The first index whose element is greater than key, as std::upper_bound.
+
+	size_t upper_bound(T key) const
+	{
+		return std::min(rank<true>(key), length);
+	}
+
+	// The index of the rightmost element equal to key, or npos.
+
+	size_t find(T key) const
+	{
+		const size_t upper = upper_bound(key);
+		return upper != 0 && storage.get()[upper - 1] == key ? upper - 1 : npos;
+	}
+};
+
+#endif
@@ -0,0 +1,154 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+*/
+
+/*
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Sweeps the array size for search_array<T>::find with monobound_binary_search
+	on a plain vector as the baseline. The time is the best run in nanoseconds
+	per search, and the Speedup column is the monobound time over the
+	search_array time.
+
+	Compile using: g++ -O3 -march=native -std=c++17 search_array_bench.cpp
+
+	Usage: search_array_bench [runs] [repetitions] [seed]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <stdint.h>
+#include <vector>
+#include <plf_nanotimer_c_api.h>
+#include "binary_search.hpp"
+#include "search_array.hpp"
+
+static int runs, loop, rnd;
+
+template <typename T, typename Search>
+static double execute(const std::vector<T>& keys, long long *hits, Search&& search)
+{
+	nanotimer_data_t timer;
+	double best = 0;
+
+	nanotimer(&timer);
+
+	for (int run = runs ; run ; --run)
+	{
+		*hits = 0;
+
+		nanotimer_start(&timer);
+
+		for (const T& key : keys)
+		{
+			*hits += search(key);
+		}
+
+		double duration = nanotimer_get_elapsed_us(&timer);
+
+		if (best == 0 || duration < best)
+		{
+			best = duration;
+		}
+	}
+	return best * 1000.0 / keys.size();
+}
+
+template <typename T>
+static void sweep(const char *type_name)
+{
+	static const int sizes[] = { 10, 100, 1000, 10000, 100000, 1000000 };
+
+	printf("| %8s | %10s | %10s | %10s | %12s | %10s |\n", "Type", "Items", "Hits", "monobound", "search_array", "Speedup");
+	printf("| %8s | %10s | %10s | %10s | %12s | %10s |\n", "--------", "----------", "----------", "----------", "------------", "----------");
+
+	for (int max : sizes)
+	{
+		std::vector<T> array(max), keys(loop);
+		long long val = 0, hits[2] = { 0, 0 };
+
+		srand(rnd);
+
+		for (auto& element : array)
+		{
+			element = (T) (val += rand() % 4);
+		}
+
+		for (auto& key : keys)
+		{
+			key = (T) (rand() % (val + 4));
+		}
+
+		search_array<T> sorted(array);
+
+		// read through volatiles so the compiler cannot hoist a cheap search
+		// out of the runs loop; the hits are compared for the same reason
+
+		const std::vector<T> *volatile plain = &array;
+		const search_array<T> *volatile padded = &sorted;
+
+		double monobound = execute(keys, &hits[0], [&](const T& key)
+		{
+			const std::vector<T>& values = *plain;
+
+			return monobound_binary_search(values, key) != values.end();
+		});
+
+		double aligned = execute(keys, &hits[1], [&](const T& key)
+		{
+			return padded->find(key) != search_array<T>::npos;
+		});
+
+		if (hits[1] != hits[0])
+		{
+			fprintf(stderr, "search_array found %lld keys instead of %lld\n", hits[1], hits[0]);
+		}
+
+		printf("| %8s | %10d | %10lld | %10.2f | %12.2f | %10.2f |\n", type_name, max, hits[0], monobound, aligned, monobound / aligned);
+	}
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	runs = 100;
+	loop = 10000;
+	rnd = time(NULL);
+
+	if (argc > 1)
+		runs = atoi(argv[1]);
+
+	if (argc > 2)
+		loop = atoi(argv[2]);
+
+	if (argc > 3)
+		rnd = atoi(argv[3]);
+
+	printf("Benchmark: runs: %d, repetitions: %d, seed: %d\n\n", runs, loop, rnd);
+
+	sweep<int32_t>("int32");
+	sweep<int64_t>("int64");
+	sweep<double>("double");
+
+	return 0;
+}
@@ -0,0 +1,147 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SEGMENTED_SEARCH_HPP
+#define SEGMENTED_SEARCH_HPP
+#include <deque>
+#include <iterator>
+#include <cstddef>
+#include "binary_search.hpp"
+
+
+
+// Describes how a container splits its elements into contiguous segments. A
+// specialization sets segmented and provides, for every segment s below
+// segment_count(c), its elements as a pointer range and the index of its first
+// element in the container:
+//
+//	static constexpr bool segmented = true;
+//	static size_t segment_count(const Container& c);
+//	static const value_type* segment_begin(const Container& c, size_t s);
+//	static const value_type* segment_end(const Container& c, size_t s);
+//	static size_t segment_offset(const Container& c, size_t s);
+//
+// Segments must not be empty. Containers without a specialization are
+// searched through their iterators.
+
+template <typename Container>
+struct segment_traits
+{
+	static constexpr bool segmented = false;
+};
+
+#if defined(__GLIBCXX__)
+
+// libstdc++ keeps a deque in equally sized blocks, reachable through the
+// block map that its iterators point into.
+
+template <typename T, typename Allocator>
+struct segment_traits<std::deque<T, Allocator>>
+{
+	using container = std::deque<T, Allocator>;
+	using value_type = T;
+
+	static constexpr bool segmented = true;
+
+	static size_t segment_count(const container& c)
+	{
+		if (c.empty())
+			return 0;
+
+		const auto first = c.begin(), last = c.end();
+		return (size_t)(last._M_node - first._M_node) + (last._M_cur != last._M_first);
+	}
+
+	static const T* segment_begin(const container& c, size_t s)
+	{
+		return s == 0 ? c.begin()._M_cur : *(c.begin()._M_node + s);
+	}
+
+	static const T* segment_end(const container& c, size_t s)
+	{
+		const auto first = c.begin(), last = c.end();
+		const auto node = first._M_node + s;
+
+		if (node == last._M_node)
+			return last._M_cur;
+		return s == 0 ? first._M_last : *node + (first._M_last - first._M_first);
+	}
+
+	static size_t segment_offset(const container& c, size_t s)
+	{
+		const auto first = c.begin();
+		return s == 0 ? 0 : (size_t)(first._M_last - first._M_cur) + (s - 1) * (size_t)(first._M_last - first._M_first);
+	}
+};
+
+#endif
+
+// Finds the rightmost element equal to key in a sorted segmented container and
+// returns its index, or c.size(). A monobound search over the first element of
+// every segment picks the only segment that can hold the match, and a
+// monobound search on that segment's pointer range finishes, so no probe pays
+// for iterator arithmetic through the segment table.
+
+template <typename Container, typename T, typename LessThan, typename Equal>
+size_t segmented_binary_search(const Container& c, const T& key, LessThan&& less_than, Equal&& equal_to)
+{
+	using traits = segment_traits<Container>;
+
+	if constexpr (traits::segmented)
+	{
+		const size_t count = traits::segment_count(c);
+
+		if (count == 0 || less_than(key, *traits::segment_begin(c, 0)))
+			return c.size();
+
+		size_t bot = 0, top = count;
+
+		while (top > 1)
+		{
+			const size_t mid = top / 2;
+			if (!less_than(key, *traits::segment_begin(c, bot + mid)))
+				bot += mid;
+			top -= mid;
+		}
+
+		const auto first = traits::segment_begin(c, bot);
+		const auto last = traits::segment_end(c, bot);
+		const auto found = ::monobound_binary_search(first, last, key, less_than, equal_to);
+
+		return found == last ? c.size() : traits::segment_offset(c, bot) + (size_t)(found - first);
+	}
+	else
+	{
+		const auto found = ::monobound_binary_search(c.begin(), c.end(), key, less_than, equal_to);
+		return (size_t)std::distance(c.begin(), found);
+	}
+}
+
+template <typename Container, typename T>
+size_t segmented_binary_search(const Container& c, const T& key)
+{
+	return ::segmented_binary_search(c, key,
+		[](auto& key, auto& right) { return key < right; },
+		[](auto& key, auto& right) { return key == right; });
+}
+
+#endif
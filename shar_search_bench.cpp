@@ -0,0 +1,149 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+*/
+
+/*
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Sweeps the array size for shar_binary_search and its unrolled ladder,
+	shar_unrolled_binary_search, with monobound_binary_search as the baseline.
+	The time is the best run in nanoseconds per search, and the Ratio column is
+	the unrolled time over the looping time.
+
+	Compile using: g++ -O3 -march=native -std=c++17 shar_search_bench.cpp
+
+	Usage: shar_search_bench [runs] [repetitions] [seed]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <stdint.h>
+#include <vector>
+#include <plf_nanotimer_c_api.h>
+#include "binary_search.hpp"
+
+static int runs, loop, rnd;
+
+template <typename T, typename Search>
+static double execute(const std::vector<T>& array, const std::vector<T>& keys, long long *hits, Search&& search)
+{
+	nanotimer_data_t timer;
+	double best = 0;
+
+	// read through a volatile so the compiler cannot hoist a cheap search out
+	// of the runs loop; the caller has to use the hits for the same reason
+
+	const T *volatile data = array.data();
+
+	nanotimer(&timer);
+
+	for (int run = runs ; run ; --run)
+	{
+		const T *first = data, *last = first + array.size();
+
+		*hits = 0;
+
+		nanotimer_start(&timer);
+
+		for (const T& key : keys)
+		{
+			*hits += search(first, last, key) != last;
+		}
+
+		double duration = nanotimer_get_elapsed_us(&timer);
+
+		if (best == 0 || duration < best)
+		{
+			best = duration;
+		}
+	}
+	return best * 1000.0 / keys.size();
+}
+
+template <typename T>
+static void sweep(const char *type_name)
+{
+	static const int sizes[] = { 10, 100, 1000, 10000, 100000, 1000000, 32000000 };
+
+	printf("| %8s | %10s | %10s | %10s | %10s | %13s | %10s |\n", "Type", "Items", "Hits", "monobound", "shar", "shar unrolled", "Ratio");
+	printf("| %8s | %10s | %10s | %10s | %10s | %13s | %10s |\n", "--------", "----------", "----------", "----------", "----------", "-------------", "----------");
+
+	for (int max : sizes)
+	{
+		std::vector<T> array(max), keys(loop);
+		long long val = 0, hits[3] = { 0, 0, 0 };
+
+		srand(rnd);
+
+		for (auto& element : array)
+		{
+			element = (T) (val += rand() % 4);
+		}
+
+		for (auto& key : keys)
+		{
+			key = (T) (rand() % (val + 4));
+		}
+
+		double monobound = execute(array, keys, &hits[0],
+			[](const T* begin, const T* end, const T& key) { return monobound_binary_search(begin, end, key); });
+
+		double shar = execute(array, keys, &hits[1],
+			[](const T* begin, const T* end, const T& key) { return shar_binary_search(begin, end, key); });
+
+		double unrolled = execute(array, keys, &hits[2],
+			[](const T* begin, const T* end, const T& key) { return shar_unrolled_binary_search(begin, end, key); });
+
+		if (hits[1] != hits[0] || hits[2] != hits[0])
+		{
+			fprintf(stderr, "shar searches found %lld and %lld keys instead of %lld\n", hits[1], hits[2], hits[0]);
+		}
+
+		printf("| %8s | %10d | %10lld | %10.2f | %10.2f | %13.2f | %10.2f |\n", type_name, max, hits[0], monobound, shar, unrolled, unrolled / shar);
+	}
+	printf("\n");
+}
+
+int main(int argc, char **argv)
+{
+	runs = 100;
+	loop = 10000;
+	rnd = time(NULL);
+
+	if (argc > 1)
+		runs = atoi(argv[1]);
+
+	if (argc > 2)
+		loop = atoi(argv[2]);
+
+	if (argc > 3)
+		rnd = atoi(argv[3]);
+
+	printf("Benchmark: runs: %d, repetitions: %d, seed: %d\n\n", runs, loop, rnd);
+
+	sweep<int32_t>("int32");
+	sweep<int64_t>("int64");
+	sweep<double>("double");
+
+	return 0;
+}
@@ -0,0 +1,154 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef STATIC_SORTED_TABLE_HPP
+#define STATIC_SORTED_TABLE_HPP
+#include <utility>
+#include <cstddef>
+
+
+
+template <typename Key, typename Value>
+struct static_table_entry
+{
+	Key key;
+	Value value;
+};
+
+// A keyword, opcode or enum table that is sorted while compiling. The
+// initializer can be in any order; equal keys keep their order and lookups
+// return the last of them, as the monobound search does.
+//
+// Since the size is a template parameter, the monobound top sequence is known
+// while compiling, and find() expands it into a fixed ladder of conditional
+// adds with constant offsets. A table declared constexpr costs nothing at
+// startup, and a lookup of a constant key folds to a constant.
+
+template <typename Key, typename Value, size_t N>
+class static_sorted_table
+{
+	static_assert(N > 0, "a static_sorted_table needs at least one entry");
+
+	Key keys[N] = {};
+	Value values[N] = {};
+
+	static constexpr size_t step(size_t round)
+	{
+		size_t top = N;
+
+		while (round--)
+			top -= top / 2;
+		return top / 2;
+	}
+
+	static constexpr size_t rounds()
+	{
+		size_t top = N, count = 0;
+
+		for (; top > 1; ++count)
+			top -= top / 2;
+		return count;
+	}
+
+	template <size_t Round>
+	static constexpr size_t step_v = step(Round);
+
+	template <size_t... Round>
+	constexpr size_t rightmost(const Key& key, std::index_sequence<Round...>) const
+	{
+		size_t bot = 0;
+
+		((bot += key < keys[bot + step_v<Round>] ? 0 : step_v<Round>), ...);
+		return bot;
+	}
+
+public:
+	static constexpr size_t npos = (size_t)-1;
+
+	// Insertion sort, since std::sort is only constexpr from C++20 on and the
+	// tables are small.
+
+	constexpr explicit static_sorted_table(const static_table_entry<Key, Value> (&entries)[N])
+	{
+		for (size_t i = 0; i != N; ++i)
+		{
+			size_t j = i;
+
+			for (; j != 0 && entries[i].key < keys[j - 1]; --j)
+			{
+				keys[j] = keys[j - 1];
+				values[j] = values[j - 1];
+			}
+			keys[j] = entries[i].key;
+			values[j] = entries[i].value;
+		}
+	}
+
+	constexpr size_t size() const { return N; }
+	constexpr const Key& key(size_t index) const { return keys[index]; }
+	constexpr const Value& value(size_t index) const { return values[index]; }
+
+	// The index of the last entry with key, or npos.
+
+	constexpr size_t find(const Key& key) const
+	{
+		const size_t bot = rightmost(key, std::make_index_sequence<rounds()>());
+		return keys[bot] == key ? bot : npos;
+	}
+
+	constexpr const Value* lookup(const Key& key) const
+	{
+		const size_t index = find(key);
+		return index == npos ? nullptr : &values[index];
+	}
+
+	constexpr Value value_or(const Key& key, const Value& fallback) const
+	{
+		const size_t index = find(key);
+		return index == npos ? fallback : values[index];
+	}
+
+#if defined(__cpp_consteval)
+	// Resolves a key while compiling. A key that is not in the table does not
+	// compile, which catches misspelled keywords at the call site.
+
+	consteval size_t index_of(const Key& key) const
+	{
+		const size_t index = find(key);
+
+		if (index == npos)
+			throw "key not in static_sorted_table";
+		return index;
+	}
+#endif
+};
+
+// Deduces the size from the initializer:
+// constexpr auto opcodes = make_static_sorted_table<std::string_view, int>({ { "mov", 1 }, { "add", 2 } });
+
+template <typename Key, typename Value, size_t N>
+constexpr static_sorted_table<Key, Value, N> make_static_sorted_table(const static_table_entry<Key, Value> (&entries)[N])
+{
+	return static_sorted_table<Key, Value, N>(entries);
+}
+
+#endif
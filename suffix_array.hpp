@@ -0,0 +1,230 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef SUFFIX_ARRAY_HPP
+#define SUFFIX_ARRAY_HPP
+#include <vector>
+#include <string_view>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include "binary_search.hpp"
+
+
+
+struct suffix_range
+{
+	size_t begin, end;
+};
+
+// Substring search on a suffix array. A pattern occurs at text offsets
+// sa[begin .. end), both bounds found with a monobound search over the
+// suffixes. Following Manber and Myers, the search remembers how many leading
+// characters the pattern shares with the last suffix it went past on either
+// side; every suffix in between shares at least the smaller of the two, so
+// each probe only compares characters it has not seen yet. The text is not
+// copied and has to outlive the suffix array.
+
+class suffix_array
+{
+	std::string_view text;
+	std::vector<uint32_t> sa;
+
+	struct probe
+	{
+		size_t lcp;
+		bool before;
+	};
+
+	// Compares the suffix at sa[index] with the pattern from offset skip on.
+	// before is true when the suffix sorts before the pattern, or, for the
+	// upper bound, when the pattern is a prefix of the suffix.
+
+	probe compare(size_t index, std::string_view pattern, size_t skip, bool upper) const
+	{
+		const size_t start = sa[index];
+		const size_t length = text.size() - start;
+		size_t lcp = skip;
+
+		while (lcp < pattern.size() && lcp < length && text[start + lcp] == pattern[lcp])
+			++lcp;
+
+		if (lcp == pattern.size())
+			return { lcp, upper };
+		if (lcp == length)
+			return { lcp, true };
+		return { lcp, (unsigned char)text[start + lcp] < (unsigned char)pattern[lcp] };
+	}
+
+	// The number of suffixes that sort before the pattern, or with upper set,
+	// before or starting with the pattern.
+
+	size_t bound(std::string_view pattern, bool upper) const
+	{
+		size_t bot = 0, top = sa.size();
+		size_t low_lcp = 0, high_lcp = 0;
+		bool settled = false;
+
+		if (top == 0)
+			return 0;
+
+		while (top > 1)
+		{
+			const size_t mid = top / 2;
+			const probe result = compare(bot + mid, pattern, std::min(low_lcp, high_lcp), upper);
+
+			if (result.before)
+			{
+				bot += mid;
+				low_lcp = result.lcp;
+				settled = true;
+			}
+			else
+				high_lcp = result.lcp;
+			top -= mid;
+		}
+
+		if (settled)
+			return bot + 1;
+		return compare(bot, pattern, std::min(low_lcp, high_lcp), upper).before ? bot + 1 : bot;
+	}
+
+public:
+	// Builds the suffix array by prefix doubling.
+
+	explicit suffix_array(std::string_view text)
+		: text(text), sa(text.size())
+	{
+		const size_t size = text.size();
+		std::vector<uint32_t> rank(size), next(size);
+
+		assert(size <= UINT32_MAX);
+
+		for (size_t i = 0; i != size; ++i)
+		{
+			sa[i] = (uint32_t)i;
+			rank[i] = (unsigned char)text[i];
+		}
+
+		for (size_t step = 1; size > 1; step *= 2)
+		{
+			auto key = [&](uint32_t i) { return std::make_pair(rank[i], i + step < size ? (int64_t)rank[i + step] : -1); };
+
+			std::sort(sa.begin(), sa.end(), [&](uint32_t left, uint32_t right) { return key(left) < key(right); });
+
+			next[sa[0]] = 0;
+			for (size_t i = 1; i != size; ++i)
+				next[sa[i]] = next[sa[i - 1]] + (key(sa[i - 1]) < key(sa[i]));
+			rank.swap(next);
+
+			if (rank[sa[size - 1]] == size - 1)
+				break;
+		}
+	}
+
+	size_t size() const { return sa.size(); }
+	const std::vector<uint32_t>& suffixes() const { return sa; }
+
+	// The suffixes starting with pattern; sa[begin .. end) are its offsets.
+
+	suffix_range find(std::string_view pattern) const
+	{
+		const size_t begin = bound(pattern, false);
+		return { begin, std::max(begin, bound(pattern, true)) };
+	}
+
+	size_t count(std::string_view pattern) const
+	{
+		const suffix_range range = find(pattern);
+		return range.end - range.begin;
+	}
+
+	// Looks up a batch of patterns. All searches of a group share the same
+	// monobound top sequence, so they run in lockstep and the suffix array
+	// entry and text of every next probe are prefetched a round ahead.
+
+	void find_batch(const std::string_view* patterns, size_t count, suffix_range* out) const
+	{
+		constexpr size_t width = monobound_batch_width;
+		size_t bot[width], low_lcp[width], high_lcp[width];
+		bool settled[width];
+
+		for (size_t base = 0; base < count; base += width)
+		{
+			const size_t group = count - base < width ? count - base : width;
+
+			for (int upper = 0; upper != 2; ++upper)
+			{
+				size_t top = sa.size();
+
+				for (size_t j = 0; j != group; ++j)
+				{
+					bot[j] = low_lcp[j] = high_lcp[j] = 0;
+					settled[j] = false;
+				}
+
+				while (top > 1)
+				{
+					const size_t mid = top / 2;
+
+					for (size_t j = 0; j != group; ++j)
+						BINARY_SEARCH_PREFETCH(text.data() + sa[bot[j] + mid] + std::min(low_lcp[j], high_lcp[j]));
+
+					for (size_t j = 0; j != group; ++j)
+					{
+						const probe result = compare(bot[j] + mid, patterns[base + j], std::min(low_lcp[j], high_lcp[j]), upper);
+
+						if (result.before)
+						{
+							bot[j] += mid;
+							low_lcp[j] = result.lcp;
+							settled[j] = true;
+						}
+						else
+							high_lcp[j] = result.lcp;
+					}
+					top -= mid;
+
+					for (size_t j = 0; j != group; ++j)
+						BINARY_SEARCH_PREFETCH(&sa[bot[j] + top / 2]);
+				}
+
+				for (size_t j = 0; j != group; ++j)
+				{
+					size_t position = bot[j];
+
+					if (sa.empty())
+						position = 0;
+					else if (settled[j] || compare(position, patterns[base + j], std::min(low_lcp[j], high_lcp[j]), upper).before)
+						++position;
+
+					if (upper)
+						out[base + j].end = std::max(out[base + j].begin, position);
+					else
+						out[base + j].begin = position;
+				}
+			}
+		}
+	}
+};
+
+#endif
@@ -0,0 +1,136 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+*/
+
+/*
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Sweeps the tail width of tapped_binary_search for several key types, to
+	find the best tap count for an array size and machine. The Hits column
+	should agree between all rows of the same key type.
+
+	Compile using: g++ -O3 -march=native -std=c++17 tapped_search_bench.cpp
+
+	Usage: tapped_search_bench [items] [runs] [repetitions] [seed]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <stdint.h>
+#include <vector>
+#include <algorithm>
+#include <utility>
+#include <plf_nanotimer_c_api.h>
+#include "binary_search.hpp"
+
+static int max, runs, loop, rnd;
+
+template <typename T, size_t Taps>
+static void execute(const std::vector<T>& array, const std::vector<T>& keys, const char *type_name)
+{
+	nanotimer_data_t timer;
+	double best = 0;
+	long long hits = 0;
+	char name[64];
+
+	nanotimer(&timer);
+
+	for (int run = runs ; run ; --run)
+	{
+		hits = 0;
+
+		nanotimer_start(&timer);
+
+		for (const T& key : keys)
+		{
+			hits += tapped_binary_search<Taps>(array.data(), array.data() + array.size(), key) != array.data() + array.size();
+		}
+
+		double duration = nanotimer_get_elapsed_us(&timer);
+
+		if (best == 0 || duration < best)
+		{
+			best = duration;
+		}
+	}
+
+	snprintf(name, sizeof(name), "tapped<%zu> %s", Taps, type_name);
+
+	printf("| %30s | %10d | %10lld | %10lld | %10f |\n", name, max, hits, (long long) keys.size() - hits, best / 1000000.0);
+}
+
+template <typename T, size_t... Taps>
+static void sweep(const char *type_name, std::index_sequence<Taps...>)
+{
+	std::vector<T> array(max), keys(loop);
+	long long val = 0;
+
+	srand(rnd);
+
+	for (auto& element : array)
+	{
+		element = (T) (val += rand() % 4);
+	}
+
+	for (auto& key : keys)
+	{
+		key = (T) (rand() % (val + 4));
+	}
+
+	(execute<T, Taps>(array, keys, type_name), ...);
+
+	printf("| %30s | %10s | %10s | %10s | %10s |\n", "", "", "", "", "");
+}
+
+using tap_counts = std::index_sequence<2, 3, 4, 6, 8, 12, 16, 24, 32>;
+
+int main(int argc, char **argv)
+{
+	max = 100000;
+	runs = 100;
+	loop = 10000;
+	rnd = time(NULL);
+
+	if (argc > 1)
+		max = atoi(argv[1]);
+
+	if (argc > 2)
+		runs = atoi(argv[2]);
+
+	if (argc > 3)
+		loop = atoi(argv[3]);
+
+	if (argc > 4)
+		rnd = atoi(argv[4]);
+
+	printf("Benchmark: array size: %d, runs: %d, repetitions: %d, seed: %d\n\n", max, runs, loop, rnd);
+
+	printf("| %30s | %10s | %10s | %10s | %10s |\n", "Name", "Items", "Hits", "Misses", "Time");
+	printf("| %30s | %10s | %10s | %10s | %10s |\n", "----------", "----------", "----------", "----------", "----------");
+
+	sweep<int32_t>("int32", tap_counts());
+	sweep<int64_t>("int64", tap_counts());
+	sweep<double>("double", tap_counts());
+
+	return 0;
+}
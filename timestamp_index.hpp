@@ -0,0 +1,158 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef TIMESTAMP_INDEX_HPP
+#define TIMESTAMP_INDEX_HPP
+#include <cstdint>
+#include <cstddef>
+#include <cassert>
+#include "binary_search.hpp"
+
+
+
+struct timestamp_window
+{
+	int64_t begin, end;
+};
+
+struct timestamp_slice
+{
+	size_t begin, end;
+};
+
+// Floor, ceiling and nearest lookups on a non-decreasing array of 64 bit
+// timestamps, built on monobound_interpolated_search() and, for the batched
+// slices, exponential_search_from(). Both return the rightmost element that
+// passes their match test, so matching every timestamp at or before t turns
+// them into floor searches. The interpolation estimate goes through
+// interpolation_search_distance(), which cannot overflow on timestamps spread
+// across the full 64 bit range, and it only steers the search, so results
+// stay exact. The index does not own the array.
+
+class timestamp_index
+{
+	const int64_t* array;
+	size_t size;
+
+	// The number of timestamps <= t.
+
+	size_t upper_count(int64_t t) const
+	{
+		const int64_t* found = ::monobound_interpolated_search_base(array, array + size, t,
+			[&](const int64_t& right) { return t < right; },
+			[&](const int64_t& right) { return !(t < right); });
+
+		return found == array + size ? 0 : found - array + 1;
+	}
+
+	// The same, galloping outward from the hint.
+
+	size_t upper_count(int64_t t, size_t hint) const
+	{
+		const int64_t* found = ::exponential_search_from_base(array, array + size, array + hint,
+			[&](const int64_t& right) { return t < right; },
+			[&](const int64_t& right) { return !(t < right); });
+
+		return found == array + size ? 0 : found - array + 1;
+	}
+
+	// The number of timestamps < t.
+
+	size_t lower_count(int64_t t) const
+	{
+		return t == INT64_MIN ? 0 : upper_count(t - 1);
+	}
+
+	size_t lower_count(int64_t t, size_t hint) const
+	{
+		return t == INT64_MIN ? 0 : upper_count(t - 1, hint);
+	}
+
+public:
+	static constexpr size_t npos = (size_t)-1;
+
+	constexpr timestamp_index(const int64_t* array, size_t size)
+		: array(array), size(size)
+	{
+	}
+
+	// The last sample at or before t.
+
+	size_t floor(int64_t t) const
+	{
+		return upper_count(t) - 1;
+	}
+
+	// The first sample at or after t.
+
+	size_t ceiling(int64_t t) const
+	{
+		const size_t index = lower_count(t);
+		return index == size ? npos : index;
+	}
+
+	// The sample closest to t, ties go to the earlier sample. When several
+	// samples share that timestamp the last one is returned, as floor() does.
+
+	size_t nearest(int64_t t) const
+	{
+		const size_t count = upper_count(t);
+
+		if (count == 0)
+			return size == 0 ? npos : 0;
+		if (count == size || array[count - 1] == t)
+			return count - 1;
+		return (uint64_t)t - (uint64_t)array[count - 1] <= (uint64_t)array[count] - (uint64_t)t ? count - 1 : count;
+	}
+
+	// The samples in [window.begin, window.end).
+
+	timestamp_slice slice(timestamp_window window) const
+	{
+		const size_t begin = lower_count(window.begin);
+		if (window.end <= window.begin)
+			return { begin, begin };
+		return { begin, lower_count(window.end, begin) };
+	}
+
+	// Slices a batch of windows. Every search gallops from the previous result,
+	// which makes ascending or overlapping windows cost a handful of probes each.
+
+	void slice(const timestamp_window* windows, size_t count, timestamp_slice* out) const
+	{
+		if (count == 0)
+			return;
+
+		size_t hint = lower_count(windows[0].begin);
+
+		for (size_t i = 0; i != count; ++i)
+		{
+			const size_t begin = i == 0 ? hint : lower_count(windows[i].begin, hint);
+			const size_t end = windows[i].end <= windows[i].begin ? begin : lower_count(windows[i].end, begin);
+
+			out[i] = { begin, end };
+			hint = begin;
+		}
+	}
+};
+
+#endif
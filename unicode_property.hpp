@@ -0,0 +1,239 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef UNICODE_PROPERTY_HPP
+#define UNICODE_PROPERTY_HPP
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include "binary_search.hpp"
+
+
+
+constexpr char32_t unicode_limit = 0x110000;
+
+template <typename Value>
+struct unicode_range
+{
+	char32_t first, last;
+	Value value;
+};
+
+// Sorts the ranges, clips them to the code space and fills every gap with the
+// fallback value, so each code point below unicode_limit falls in exactly one
+// range. Adjacent ranges with the same value are merged. Overlapping ranges
+// are resolved in favour of the one that starts first.
+
+template <typename Value>
+std::vector<unicode_range<Value>> unicode_cover(std::vector<unicode_range<Value>> ranges, Value fallback)
+{
+	std::vector<unicode_range<Value>> cover;
+	char32_t next = 0;
+
+	std::sort(ranges.begin(), ranges.end(),
+		[](const unicode_range<Value>& left, const unicode_range<Value>& right) { return left.first < right.first; });
+
+	auto append = [&](char32_t first, char32_t last, Value value)
+	{
+		if (!cover.empty() && cover.back().value == value)
+			cover.back().last = last;
+		else
+			cover.push_back({ first, last, value });
+	};
+
+	for (auto& range : ranges)
+	{
+		char32_t first = range.first < next ? next : range.first;
+		char32_t last = range.last < unicode_limit ? range.last : unicode_limit - 1;
+
+		if (first > last || first >= unicode_limit)
+			continue;
+		if (first > next)
+			append(next, first - 1, fallback);
+		append(first, last, range.value);
+		next = last + 1;
+	}
+
+	if (next < unicode_limit)
+		append(next, unicode_limit - 1, fallback);
+
+	return cover;
+}
+
+// Two-stage table: the high bits of a code point select a block in the index,
+// the low bits an entry in that block's leaf. Identical leaves are stored once,
+// so a typical property costs a few dozen kilobytes and every lookup is two
+// dependent loads without a single comparison.
+
+template <typename Value = uint8_t>
+class unicode_property_trie
+{
+	static constexpr unsigned block_bits = 7;
+	static constexpr char32_t block_size = 1 << block_bits;
+
+	std::vector<uint16_t> index;
+	std::vector<Value> leaves;
+	Value fallback;
+
+public:
+	unicode_property_trie(const std::vector<unicode_range<Value>>& ranges, Value fallback)
+		: fallback(fallback)
+	{
+		const auto cover = ::unicode_cover(ranges, fallback);
+		std::map<std::vector<Value>, uint16_t> unique;
+		std::vector<Value> leaf(block_size);
+		size_t range = 0;
+
+		index.reserve(unicode_limit / block_size);
+
+		for (char32_t block = 0; block < unicode_limit; block += block_size)
+		{
+			for (char32_t offset = 0; offset < block_size; ++offset)
+			{
+				while (cover[range].last < block + offset)
+					++range;
+				leaf[offset] = cover[range].value;
+			}
+
+			auto found = unique.emplace(leaf, (uint16_t)(leaves.size() / block_size));
+			if (found.second)
+				leaves.insert(leaves.end(), leaf.begin(), leaf.end());
+			index.push_back(found.first->second);
+		}
+	}
+
+	Value operator()(char32_t code_point) const
+	{
+		if (code_point >= unicode_limit)
+			return fallback;
+		return leaves[((size_t)index[code_point >> block_bits] << block_bits) | (code_point & (block_size - 1))];
+	}
+
+	size_t memory() const
+	{
+		return index.size() * sizeof(uint16_t) + leaves.size() * sizeof(Value);
+	}
+};
+
+// Sorted range table. Text tends to stay within one script, so each lookup
+// first checks the range of the previous lookup, then gallops outward from it
+// and finishes with a monobound search, much like adaptive_binary_search().
+// The cursor carries that state and belongs to a single text stream.
+
+template <typename Value = uint8_t>
+class unicode_property_ranges
+{
+	std::vector<char32_t> starts;
+	std::vector<Value> values;
+
+public:
+	struct cursor
+	{
+		size_t i = 0;
+	};
+
+	unicode_property_ranges(const std::vector<unicode_range<Value>>& ranges, Value fallback)
+	{
+		for (auto& range : ::unicode_cover(ranges, fallback))
+		{
+			starts.push_back(range.first);
+			values.push_back(range.value);
+		}
+		starts.push_back(unicode_limit);
+		values.push_back(fallback);
+	}
+
+	const std::vector<char32_t>& range_starts() const { return starts; }
+	const std::vector<Value>& range_values() const { return values; }
+
+	Value operator()(char32_t code_point) const
+	{
+		auto found = ::monobound_binary_search_base(starts.begin(), starts.end(),
+			[&](char32_t right) { return code_point < right; },
+			[](char32_t) { return true; });
+		return values[found - starts.begin()];
+	}
+
+	Value operator()(char32_t code_point, cursor& state) const
+	{
+		const size_t size = starts.size();
+		size_t bot = state.i, top = 1;
+
+		if (code_point >= starts[bot])
+		{
+			if (bot + 1 == size || code_point < starts[bot + 1])
+				return values[bot];
+
+			while (true)
+			{
+				if (bot + top >= size)
+				{
+					top = size - bot;
+					break;
+				}
+				bot += top;
+				if (code_point < starts[bot])
+				{
+					bot -= top;
+					break;
+				}
+				top *= 2;
+			}
+		}
+		else
+		{
+			while (true)
+			{
+				if (bot < top)
+				{
+					top = bot;
+					bot = 0;
+					break;
+				}
+				bot -= top;
+				if (code_point >= starts[bot])
+					break;
+				top *= 2;
+			}
+		}
+
+		while (top > 1)
+		{
+			const size_t mid = top / 2;
+			if (code_point >= starts[bot + mid])
+				bot += mid;
+			top -= mid;
+		}
+
+		state.i = bot;
+		return values[bot];
+	}
+
+	size_t memory() const
+	{
+		return starts.size() * sizeof(char32_t) + values.size() * sizeof(Value);
+	}
+};
+
+#endif
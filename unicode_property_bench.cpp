@@ -0,0 +1,288 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+*/
+
+/*
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Compares Unicode property lookups on a stream of code points decoded
+	from UTF-8 text. The property comes from a UCD style range file such as
+	Scripts.txt or Blocks.txt, or from a built-in table of common blocks.
+
+	Compile using: g++ -O3 -std=c++17 unicode_property_bench.cpp
+
+	Usage: unicode_property_bench [text file] [UCD range file] [runs]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <string>
+#include <vector>
+#include <map>
+#include <plf_nanotimer_c_api.h>
+#include "unicode_property.hpp"
+
+static const unicode_range<uint8_t> builtin_blocks[] =
+{
+	{ 0x0000, 0x007F,  1 }, { 0x0080, 0x00FF,  2 }, { 0x0100, 0x017F,  3 }, { 0x0180, 0x024F,  4 },
+	{ 0x0250, 0x02AF,  5 }, { 0x02B0, 0x02FF,  6 }, { 0x0300, 0x036F,  7 }, { 0x0370, 0x03FF,  8 },
+	{ 0x0400, 0x04FF,  9 }, { 0x0500, 0x052F, 10 }, { 0x0530, 0x058F, 11 }, { 0x0590, 0x05FF, 12 },
+	{ 0x0600, 0x06FF, 13 }, { 0x0700, 0x074F, 14 }, { 0x0900, 0x097F, 15 }, { 0x0980, 0x09FF, 16 },
+	{ 0x0E00, 0x0E7F, 17 }, { 0x10A0, 0x10FF, 18 }, { 0x1100, 0x11FF, 19 }, { 0x1E00, 0x1EFF, 20 },
+	{ 0x1F00, 0x1FFF, 21 }, { 0x2000, 0x206F, 22 }, { 0x20A0, 0x20CF, 23 }, { 0x2100, 0x214F, 24 },
+	{ 0x2190, 0x21FF, 25 }, { 0x2200, 0x22FF, 26 }, { 0x2500, 0x257F, 27 }, { 0x2600, 0x26FF, 28 },
+	{ 0x3000, 0x303F, 29 }, { 0x3040, 0x309F, 30 }, { 0x30A0, 0x30FF, 31 }, { 0x4E00, 0x9FFF, 32 },
+	{ 0xAC00, 0xD7AF, 33 }, { 0xE000, 0xF8FF, 34 }, { 0xFF00, 0xFFEF, 35 }, { 0x1F300, 0x1F5FF, 36 },
+	{ 0x1F600, 0x1F64F, 37 }, { 0x20000, 0x2A6DF, 38 }
+};
+
+static const char *builtin_text[] =
+{
+	"The quick brown fox jumps over the lazy dog, while the café owner counts 42 croissants. ",
+	"Η γρήγορη καφέ αλεπού πηδάει πάνω από τον τεμπέλη σκύλο. ",
+	"Съешь же ещё этих мягких французских булок, да выпей чаю. ",
+	"敏捷的棕色狐狸跳过了懒狗。今天天气很好，我们去公园散步吧。",
+	"いろはにほへと ちりぬるを わかよたれそ つねならむ。カタカナもあります。",
+	"다람쥐 헌 쳇바퀴에 타고파. 키스의 고유조건은 입술끼리 만나야 하고 특별한 기술은 필요치 않다. ",
+	"نص حكيم له سر قاطع وذو شأن عظيم مكتوب على ثوب أخضر. ",
+	"ऋषियों को सताने वाले दुष्ट राक्षसों के राजा रावण का सर्वनाश करने वाले विष्णुवतार भगवान श्रीराम। ",
+	"Prices rose 5% → €12.50 ± 0.3 ✓ 😀🎉 ",
+};
+
+static std::vector<char32_t> decode_utf8(const std::string& text)
+{
+	std::vector<char32_t> code_points;
+	size_t pos = 0;
+
+	while (pos < text.size())
+	{
+		unsigned char c = text[pos];
+		char32_t cp;
+		size_t len;
+
+		if (c < 0x80)
+		{
+			cp = c, len = 1;
+		}
+		else if ((c & 0xE0) == 0xC0)
+		{
+			cp = c & 0x1F, len = 2;
+		}
+		else if ((c & 0xF0) == 0xE0)
+		{
+			cp = c & 0x0F, len = 3;
+		}
+		else if ((c & 0xF8) == 0xF0)
+		{
+			cp = c & 0x07, len = 4;
+		}
+		else
+		{
+			pos++;
+			continue;
+		}
+
+		if (pos + len > text.size())
+		{
+			break;
+		}
+
+		for (size_t cnt = 1 ; cnt < len ; cnt++)
+		{
+			cp = cp << 6 | (text[pos + cnt] & 0x3F);
+		}
+		code_points.push_back(cp);
+		pos += len;
+	}
+	return code_points;
+}
+
+static std::string read_file(const char *name)
+{
+	std::string text;
+	char buffer[65536];
+	size_t len;
+	FILE *fp = fopen(name, "rb");
+
+	if (fp == NULL)
+	{
+		perror(name);
+		exit(1);
+	}
+
+	while ((len = fread(buffer, 1, sizeof(buffer), fp)) > 0)
+	{
+		text.append(buffer, len);
+	}
+	fclose(fp);
+
+	return text;
+}
+
+// parses lines like "0041..005A    ; Latin # L&  [26] ..."
+
+static std::vector<unicode_range<uint8_t>> read_ranges(const char *name)
+{
+	std::vector<unicode_range<uint8_t>> ranges;
+	std::map<std::string, uint8_t> names;
+	std::string text = read_file(name);
+	char line[1024], value[256];
+	unsigned int first, last;
+	size_t pos = 0;
+
+	while (pos < text.size())
+	{
+		size_t eol = text.find('\n', pos);
+
+		if (eol == std::string::npos)
+		{
+			eol = text.size();
+		}
+		snprintf(line, sizeof(line), "%.*s", (int) (eol - pos), text.c_str() + pos);
+		pos = eol + 1;
+
+		if (sscanf(line, "%x..%x ; %255[^#;\r\n]", &first, &last, value) != 3)
+		{
+			if (sscanf(line, "%x ; %255[^#;\r\n]", &first, value) != 2)
+			{
+				continue;
+			}
+			last = first;
+		}
+
+		std::string key(value);
+
+		key.erase(key.find_last_not_of(" \t") + 1);
+
+		auto found = names.emplace(key, (uint8_t) (names.size() % 255 + 1));
+
+		ranges.push_back({ first, last, found.first->second });
+	}
+	return ranges;
+}
+
+static std::vector<char32_t> stream;
+static std::vector<char32_t> starts;
+static std::vector<uint8_t> values;
+static int runs;
+
+template <typename Lookup>
+static void execute(Lookup&& lookup, const char *algo_name, size_t memory)
+{
+	nanotimer_data_t timer;
+	unsigned long long checksum = 0;
+	double best = 0;
+
+	nanotimer(&timer);
+
+	for (int run = runs ; run ; --run)
+	{
+		checksum = 0;
+
+		nanotimer_start(&timer);
+
+		for (char32_t code_point : stream)
+		{
+			checksum += lookup(code_point);
+		}
+
+		double duration = nanotimer_get_elapsed_us(&timer);
+
+		if (best == 0 || duration < best)
+		{
+			best = duration;
+		}
+	}
+
+	printf("| %30s | %10zu | %10zu | %10llu | %10f | %10.1f |\n", algo_name, stream.size(), memory, checksum, best / 1000000.0, stream.size() / best);
+}
+
+int main(int argc, char **argv)
+{
+	std::vector<unicode_range<uint8_t>> ranges;
+	std::string text;
+
+	runs = 100;
+
+	if (argc > 1)
+	{
+		text = read_file(argv[1]);
+	}
+	else
+	{
+		for (int cnt = 0 ; cnt < 1000 ; cnt++)
+		{
+			text += builtin_text[cnt % (sizeof(builtin_text) / sizeof(*builtin_text))];
+		}
+	}
+
+	if (argc > 2)
+	{
+		ranges = read_ranges(argv[2]);
+	}
+	else
+	{
+		ranges.assign(builtin_blocks, builtin_blocks + sizeof(builtin_blocks) / sizeof(*builtin_blocks));
+	}
+
+	if (argc > 3)
+		runs = atoi(argv[3]);
+
+	stream = decode_utf8(text);
+
+	unicode_property_trie<uint8_t> trie(ranges, 0);
+	unicode_property_ranges<uint8_t> table(ranges, 0);
+	unicode_property_ranges<uint8_t>::cursor cursor;
+	adaptive_binary_search_state state = { 0, 0 };
+
+	starts = table.range_starts();
+	values = table.range_values();
+
+	printf("Benchmark: code points: %zu, ranges: %zu, runs: %d\n\n", stream.size(), starts.size(), runs);
+
+	printf("| %30s | %10s | %10s | %10s | %10s | %10s |\n", "Name", "Items", "Bytes", "Checksum", "Time", "Mcp/s");
+	printf("| %30s | %10s | %10s | %10s | %10s | %10s |\n", "----------", "----------", "----------", "----------", "----------", "----------");
+
+	execute([&](char32_t code_point)
+	{
+		auto found = monobound_binary_search_base(starts.begin(), starts.end(),
+			[&](char32_t right) { return code_point < right; },
+			[](char32_t) { return true; });
+		return values[found - starts.begin()];
+	}, "monobound_binary_search", table.memory());
+
+	execute([&](char32_t code_point)
+	{
+		auto found = adaptive_binary_search_base(starts.begin(), starts.end(),
+			[&](char32_t right) { return code_point < right; },
+			[&](char32_t right) { return right <= code_point; },
+			state);
+		return values[found - starts.begin()];
+	}, "adaptive_binary_search", table.memory());
+
+	execute([&](char32_t code_point) { return table(code_point, cursor); }, "unicode_property_ranges", table.memory());
+
+	execute([&](char32_t code_point) { return trie(code_point); }, "unicode_property_trie", trie.memory());
+
+	return 0;
+}
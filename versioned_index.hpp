@@ -0,0 +1,266 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef VERSIONED_INDEX_HPP
+#define VERSIONED_INDEX_HPP
+#include <atomic>
+#include <thread>
+#include <future>
+#include <mutex>
+#include <vector>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include "binary_search.hpp"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#define VERSIONED_INDEX_MMAP 1
+#endif
+
+
+
+// A sorted array that can be replaced while other threads keep searching it.
+// Readers pin the current version by bumping a striped counter of the current
+// epoch; a reload publishes the new version, flips the epoch and waits, on the
+// reloading thread only, until the counters of the old epoch drain before the
+// old version is freed. Readers never block and never touch a shared lock.
+
+template <typename T>
+class versioned_index
+{
+	struct version
+	{
+		const T* data = nullptr;
+		size_t size = 0;
+		uint64_t generation = 0;
+		std::vector<T> owned;
+		void* map = nullptr;
+		size_t map_length = 0;
+
+		~version()
+		{
+#ifdef VERSIONED_INDEX_MMAP
+			if (map != nullptr)
+				munmap(map, map_length);
+#endif
+		}
+	};
+
+	static constexpr size_t stripes = 16;
+
+	struct alignas(64) stripe
+	{
+		std::atomic<size_t> readers{ 0 };
+	};
+
+	std::atomic<version*> current;
+	std::atomic<unsigned> epoch{ 0 };
+	mutable stripe pins[2][stripes];
+	std::mutex reload_lock;
+	uint64_t generations = 0;
+
+	// the generation of current, readable without pinning the version
+
+	std::atomic<uint64_t> published{ 0 };
+
+	static size_t stripe_index()
+	{
+		static thread_local const size_t index = std::hash<std::thread::id>()(std::this_thread::get_id()) % stripes;
+		return index;
+	}
+
+	uint64_t publish(version* next)
+	{
+		std::lock_guard<std::mutex> guard(reload_lock);
+
+		next->generation = ++generations;
+		version* previous = current.exchange(next, std::memory_order_seq_cst);
+		published.store(next->generation, std::memory_order_release);
+		const unsigned old_epoch = epoch.fetch_add(1, std::memory_order_seq_cst) & 1;
+
+		for (size_t i = 0; i != stripes; ++i)
+			while (pins[old_epoch][i].readers.load(std::memory_order_seq_cst) != 0)
+				std::this_thread::yield();
+
+		delete previous;
+		return next->generation;
+	}
+
+public:
+	class snapshot
+	{
+		friend class versioned_index;
+
+		const version* pinned;
+		std::atomic<size_t>* counter;
+
+		snapshot(const version* pinned, std::atomic<size_t>* counter)
+			: pinned(pinned), counter(counter)
+		{
+		}
+
+	public:
+		snapshot(const snapshot&) = delete;
+		snapshot& operator=(const snapshot&) = delete;
+
+		snapshot(snapshot&& other) noexcept
+			: pinned(other.pinned), counter(other.counter)
+		{
+			other.counter = nullptr;
+		}
+
+		~snapshot()
+		{
+			if (counter != nullptr)
+				counter->fetch_sub(1, std::memory_order_release);
+		}
+
+		const T* begin() const { return pinned->data; }
+		const T* end() const { return pinned->data + pinned->size; }
+		size_t size() const { return pinned->size; }
+		uint64_t generation() const { return pinned->generation; }
+	};
+
+	versioned_index()
+		: current(new version)
+	{
+	}
+
+	explicit versioned_index(std::vector<T> sorted)
+		: current(new version)
+	{
+		assert(std::is_sorted(sorted.begin(), sorted.end()));
+		version* initial = current.load(std::memory_order_relaxed);
+		initial->owned = std::move(sorted);
+		initial->data = initial->owned.data();
+		initial->size = initial->owned.size();
+		initial->generation = ++generations;
+		published.store(initial->generation, std::memory_order_relaxed);
+	}
+
+	versioned_index(const versioned_index&) = delete;
+	versioned_index& operator=(const versioned_index&) = delete;
+
+	~versioned_index()
+	{
+		delete current.load(std::memory_order_relaxed);
+	}
+
+	snapshot acquire() const
+	{
+		const size_t index = stripe_index();
+
+		while (true)
+		{
+			const unsigned entered = epoch.load(std::memory_order_seq_cst);
+			std::atomic<size_t>& counter = pins[entered & 1][index].readers;
+
+			counter.fetch_add(1, std::memory_order_seq_cst);
+			if (epoch.load(std::memory_order_seq_cst) == entered)
+				return snapshot(current.load(std::memory_order_seq_cst), &counter);
+			counter.fetch_sub(1, std::memory_order_release);
+		}
+	}
+
+	uint64_t generation() const
+	{
+		return published.load(std::memory_order_acquire);
+	}
+
+	// Replaces the index with an already sorted array; blocks the caller, not
+	// the readers, until the previous version is reclaimed.
+
+	uint64_t replace(std::vector<T> sorted)
+	{
+		assert(std::is_sorted(sorted.begin(), sorted.end()));
+		version* next = new version;
+		next->owned = std::move(sorted);
+		next->data = next->owned.data();
+		next->size = next->owned.size();
+		return publish(next);
+	}
+
+	// Sorts and publishes the keys on a background thread. The future yields
+	// the new generation.
+
+	std::future<uint64_t> reload(std::vector<T> keys)
+	{
+		return std::async(std::launch::async, [this](std::vector<T> keys)
+		{
+			std::sort(keys.begin(), keys.end());
+			return replace(std::move(keys));
+		}, std::move(keys));
+	}
+
+#ifdef VERSIONED_INDEX_MMAP
+	// Maps a file holding a sorted array of T on a background thread. The
+	// sortedness check also faults every page in before readers can see it.
+	// The future yields the new generation, or 0 if the file could not be used.
+
+	std::future<uint64_t> reload_file(std::string path)
+	{
+		static_assert(std::is_trivially_copyable<T>::value, "mapped keys must be trivially copyable");
+
+		return std::async(std::launch::async, [this](std::string path) -> uint64_t
+		{
+			struct stat info;
+			int fd = open(path.c_str(), O_RDONLY);
+
+			if (fd < 0)
+				return 0;
+
+			if (fstat(fd, &info) != 0 || info.st_size == 0 || info.st_size % sizeof(T) != 0)
+			{
+				close(fd);
+				return 0;
+			}
+
+			void* map = mmap(nullptr, info.st_size, PROT_READ, MAP_SHARED, fd, 0);
+			close(fd);
+
+			if (map == MAP_FAILED)
+				return 0;
+
+			version* next = new version;
+			next->map = map;
+			next->map_length = info.st_size;
+			next->data = static_cast<const T*>(map);
+			next->size = info.st_size / sizeof(T);
+
+			if (!std::is_sorted(next->data, next->data + next->size))
+			{
+				delete next;
+				return 0;
+			}
+			return publish(next);
+		}, std::move(path));
+	}
+#endif
+};
+
+#endif
@@ -0,0 +1,169 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+*/
+
+/*
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Measures search latency percentiles on a versioned_index while it is
+	idle and while a background thread keeps reloading it.
+
+	Compile using: g++ -O3 -std=c++17 -pthread versioned_index_bench.cpp
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <algorithm>
+#include <plf_nanotimer_c_api.h>
+#include "versioned_index.hpp"
+
+static int max, loop, readers, rnd;
+
+static std::vector<int> generate(int seed)
+{
+	std::vector<int> keys(max);
+	int val = 0;
+
+	srand(seed);
+
+	for (auto& key : keys)
+	{
+		key = (val += rand() % 20);
+	}
+	return keys;
+}
+
+static void reader(versioned_index<int> *index, int seed, std::vector<double> *latency, unsigned int *hits)
+{
+	nanotimer_data_t timer;
+	unsigned int state = seed, found = 0;
+
+	nanotimer(&timer);
+
+	for (int cnt = 0 ; cnt < loop ; cnt++)
+	{
+		state = state * 1103515245 + 12345;
+
+		int key = state % (max * 10);
+
+		nanotimer_start(&timer);
+
+		auto snapshot = index->acquire();
+
+		if (monobound_binary_search(snapshot, key) != snapshot.end())
+		{
+			found++;
+		}
+
+		(*latency)[cnt] = nanotimer_get_elapsed_ns(&timer);
+	}
+
+	// counted locally, the readers' counters share a cache line
+
+	*hits = found;
+}
+
+static void execute(const char *name, int reloading)
+{
+	versioned_index<int> index(generate(rnd));
+	std::vector<std::vector<double>> latency(readers, std::vector<double>(loop));
+	std::vector<unsigned int> hits(readers);
+	std::vector<std::thread> threads;
+	std::atomic<int> done(0);
+	unsigned int reloads = 0;
+
+	std::thread reloader([&]
+	{
+		while (reloading && !done.load())
+		{
+			index.reload(generate(rnd + reloads)).wait();
+			reloads++;
+		}
+	});
+
+	for (int cnt = 0 ; cnt < readers ; cnt++)
+	{
+		threads.emplace_back(reader, &index, rnd + cnt, &latency[cnt], &hits[cnt]);
+	}
+
+	for (auto& thread : threads)
+	{
+		thread.join();
+	}
+	done.store(1);
+	reloader.join();
+
+	std::vector<double> all;
+	unsigned int hit = 0;
+
+	for (int cnt = 0 ; cnt < readers ; cnt++)
+	{
+		all.insert(all.end(), latency[cnt].begin(), latency[cnt].end());
+		hit += hits[cnt];
+	}
+	std::sort(all.begin(), all.end());
+
+	printf("| %30s | %10d | %10u | %10u | %10.0f | %10.0f | %10.0f | %10.0f |\n", name, max, hit, reloads,
+		all[all.size() / 2], all[all.size() * 99 / 100], all[all.size() * 999 / 1000], all.back());
+}
+
+int main(int argc, char **argv)
+{
+	max = 1000000;
+	loop = 1000000;
+	readers = 2;
+	rnd = time(NULL);
+
+	if (argc > 1)
+		max = atoi(argv[1]);
+
+	if (argc > 2)
+		loop = atoi(argv[2]);
+
+	if (argc > 3)
+		readers = atoi(argv[3]);
+
+	if (argc > 4)
+		rnd = atoi(argv[4]);
+
+	if (max < 1 || loop < 1 || readers < 1)
+	{
+		fprintf(stderr, "%s: needs at least one key, one lookup and one reader\n", argv[0]);
+		return 1;
+	}
+
+	printf("Benchmark: array size: %d, lookups per reader: %d, readers: %d, seed: %d\n\n", max, loop, readers, rnd);
+
+	printf("Search latency in nanoseconds\n\n");
+
+	printf("| %30s | %10s | %10s | %10s | %10s | %10s | %10s | %10s |\n", "Name", "Items", "Hits", "Reloads", "p50", "p99", "p99.9", "Max");
+	printf("| %30s | %10s | %10s | %10s | %10s | %10s | %10s | %10s |\n", "----------", "----------", "----------", "----------", "----------", "----------", "----------", "----------");
+
+	execute("steady", 0);
+	execute("reloading", 1);
+
+	return 0;
+}
@@ -0,0 +1,206 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+	Copyright (C) 2022 Marcel Pi Nacy
+
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+#ifndef WEIGHTED_SAMPLER_HPP
+#define WEIGHTED_SAMPLER_HPP
+#include <vector>
+#include <limits>
+#include <cmath>
+#include <cstdint>
+#include <cstddef>
+#include "binary_search.hpp"
+
+#if defined(__AVX2__) || defined(__SSE2__) || defined(_M_X64)
+#include <immintrin.h>
+#endif
+
+
+
+enum class sampling_backend
+{
+	automatic,
+	linear,
+	monobound,
+	alias
+};
+
+// Draws indices with probability proportional to their weight. The prefix
+// sums are built once; a draw of u in [0, total) is the rightmost prefix sum
+// <= u, which is exactly what the monobound search returns. Small tables are
+// scanned with a branchless SIMD count instead, and large tables can use a
+// Vose alias table, which needs a single random access per draw.
+
+class weighted_sampler
+{
+	std::vector<double> prefix;
+	std::vector<double> probability;
+	std::vector<uint32_t> alias;
+	double total = 0, limit = 0;
+	size_t count = 0;
+	sampling_backend chosen;
+
+	template <typename URBG>
+	static double canonical(URBG& gen)
+	{
+		static_assert(URBG::max() - URBG::min() == std::numeric_limits<uint64_t>::max(), "a 64 bit generator is required");
+		return (double)((uint64_t)(gen() - URBG::min()) >> 11) * 0x1.0p-53;
+	}
+
+	size_t linear_count(double u) const
+	{
+		size_t index = 0;
+#if defined(__AVX2__)
+		const __m256d key = _mm256_set1_pd(u);
+		for (size_t i = 0; i < prefix.size(); i += 4)
+			index += (0x4332322132212110ULL >> 4 * _mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(&prefix[i]), key, _CMP_LE_OQ))) & 15;
+#elif defined(__SSE2__) || defined(_M_X64)
+		const __m128d key = _mm_set1_pd(u);
+		for (size_t i = 0; i < prefix.size(); i += 2)
+		{
+			const int mask = _mm_movemask_pd(_mm_cmple_pd(_mm_loadu_pd(&prefix[i]), key));
+			index += (mask & 1) + (mask >> 1);
+		}
+#else
+		for (size_t i = 0; i < prefix.size(); ++i)
+			index += prefix[i] <= u;
+#endif
+		return index - 1;
+	}
+
+	void build_alias(const double* weights)
+	{
+		std::vector<uint32_t> small, large;
+		probability.resize(count);
+		alias.resize(count);
+
+		for (size_t i = 0; i != count; ++i)
+		{
+			probability[i] = weights[i] * count / total;
+			(probability[i] < 1.0 ? small : large).push_back((uint32_t)i);
+		}
+
+		while (!small.empty() && !large.empty())
+		{
+			const uint32_t less = small.back(), more = large.back();
+			small.pop_back();
+			alias[less] = more;
+			probability[more] -= 1.0 - probability[less];
+			if (probability[more] < 1.0)
+			{
+				large.pop_back();
+				small.push_back(more);
+			}
+		}
+
+		for (uint32_t i : large)
+			probability[i] = 1.0, alias[i] = i;
+		for (uint32_t i : small)
+			probability[i] = 1.0, alias[i] = i;
+	}
+
+public:
+	static constexpr size_t linear_limit = 16;
+	static constexpr size_t alias_limit = 256;
+
+	weighted_sampler(const double* weights, size_t size, sampling_backend backend = sampling_backend::automatic)
+		: count(size), chosen(backend)
+	{
+		assert(size != 0 && size <= std::numeric_limits<uint32_t>::max());
+
+		if (chosen == sampling_backend::automatic)
+			chosen = size <= linear_limit ? sampling_backend::linear : size <= alias_limit ? sampling_backend::monobound : sampling_backend::alias;
+
+		prefix.reserve(size + 4);
+		for (size_t i = 0; i != size; ++i)
+		{
+			assert(weights[i] >= 0);
+			prefix.push_back(total);
+			total += weights[i];
+		}
+		assert(total > 0);
+		limit = std::nextafter(total, 0.0);
+
+		if (chosen == sampling_backend::linear)
+			while (prefix.size() % 4)
+				prefix.push_back(std::numeric_limits<double>::infinity());
+		else if (chosen == sampling_backend::alias)
+			build_alias(weights);
+	}
+
+	size_t size() const { return count; }
+	sampling_backend backend() const { return chosen; }
+
+	template <typename URBG>
+	size_t operator()(URBG& gen) const
+	{
+		if (chosen == sampling_backend::alias)
+		{
+			const double u = canonical(gen) * count;
+			const size_t column = (size_t)u < count ? (size_t)u : count - 1;
+			return u - column < probability[column] ? column : alias[column];
+		}
+
+		const double u = std::fmin(canonical(gen) * total, limit);
+
+		if (chosen == sampling_backend::linear)
+			return linear_count(u);
+
+		auto found = ::monobound_binary_search_base(prefix.begin(), prefix.end(),
+			[&](double right) { return u < right; },
+			[](double) { return true; });
+		return found - prefix.begin();
+	}
+
+	// Draws samples into out[0 .. samples). The monobound backend searches
+	// monobound_batch_width draws at a time with monobound_batch_search().
+
+	template <typename URBG>
+	void operator()(URBG& gen, size_t* out, size_t samples) const
+	{
+		if (chosen != sampling_backend::monobound)
+		{
+			for (size_t i = 0; i != samples; ++i)
+				out[i] = (*this)(gen);
+			return;
+		}
+
+		double keys[monobound_batch_width];
+		std::vector<double>::const_iterator found[monobound_batch_width];
+
+		for (size_t base = 0; base < samples; base += monobound_batch_width)
+		{
+			const size_t group = samples - base < monobound_batch_width ? samples - base : monobound_batch_width;
+
+			for (size_t j = 0; j != group; ++j)
+				keys[j] = std::fmin(canonical(gen) * total, limit);
+
+			::monobound_batch_search_base(prefix.begin(), prefix.end(), keys, keys + group, found,
+				[](double key, double right) { return key < right; },
+				[](double, double) { return true; });
+
+			for (size_t j = 0; j != group; ++j)
+				out[base + j] = found[j] - prefix.begin();
+		}
+	}
+};
+
+#endif
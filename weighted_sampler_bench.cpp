@@ -0,0 +1,143 @@
+/*
+	Copyright (C) 2014-2021 Igor van den Hoven ivdhoven@gmail.com
+*/
+
+/*
+	Permission is hereby granted, free of charge, to any person obtaining
+	a copy of this software and associated documentation files (the
+	"Software"), to deal in the Software without restriction, including
+	without limitation the rights to use, copy, modify, merge, publish,
+	distribute, sublicense, and/or sell copies of the Software, and to
+	permit persons to whom the Software is furnished to do so, subject to
+	the following conditions:
+
+	The above copyright notice and this permission notice shall be
+	included in all copies or substantial portions of the Software.
+
+	THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND,
+	EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+	MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+	IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+	CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+	TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+	SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*/
+
+/*
+	Compares weighted_sampler backends against std::discrete_distribution.
+	The Mean column is the average drawn index, which should agree between
+	all rows of the same size.
+
+	Compile using: g++ -O3 -march=native -std=c++17 weighted_sampler_bench.cpp
+
+	Usage: weighted_sampler_bench [items] [runs] [samples] [seed]
+*/
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <time.h>
+#include <random>
+#include <vector>
+#include <plf_nanotimer_c_api.h>
+#include "weighted_sampler.hpp"
+
+static std::vector<double> weights;
+static std::vector<size_t> samples;
+static int max, runs, loop, rnd;
+
+template <typename Draw>
+static void execute(Draw&& draw, const char *algo_name)
+{
+	nanotimer_data_t timer;
+	std::mt19937_64 gen;
+	double best = 0, mean = 0;
+
+	nanotimer(&timer);
+
+	for (int run = runs ; run ; --run)
+	{
+		gen.seed(rnd);
+
+		nanotimer_start(&timer);
+
+		draw(gen);
+
+		double duration = nanotimer_get_elapsed_us(&timer);
+
+		if (best == 0 || duration < best)
+		{
+			best = duration;
+		}
+	}
+
+	for (size_t index : samples)
+	{
+		mean += index;
+	}
+
+	printf("| %30s | %10d | %10d | %10.2f | %10f | %10.1f |\n", algo_name, max, loop, mean / loop, best / 1000000.0, loop / best);
+}
+
+static void run_backend(sampling_backend backend, const char *algo_name, int batched)
+{
+	weighted_sampler sampler(weights.data(), weights.size(), backend);
+
+	if (batched)
+	{
+		execute([&](std::mt19937_64& gen) { sampler(gen, samples.data(), samples.size()); }, algo_name);
+	}
+	else
+	{
+		execute([&](std::mt19937_64& gen) { for (auto& index : samples) index = sampler(gen); }, algo_name);
+	}
+}
+
+int main(int argc, char **argv)
+{
+	max = 1000;
+	runs = 10;
+	loop = 1000000;
+	rnd = time(NULL);
+
+	if (argc > 1)
+		max = atoi(argv[1]);
+
+	if (argc > 2)
+		runs = atoi(argv[2]);
+
+	if (argc > 3)
+		loop = atoi(argv[3]);
+
+	if (argc > 4)
+		rnd = atoi(argv[4]);
+
+	srand(rnd);
+
+	weights.resize(max);
+	samples.resize(loop);
+
+	for (auto& weight : weights)
+	{
+		weight = rand() % 100 + 1;
+	}
+
+	printf("Benchmark: weights: %d, runs: %d, samples: %d, seed: %d\n\n", max, runs, loop, rnd);
+
+	printf("| %30s | %10s | %10s | %10s | %10s | %10s |\n", "Name", "Items", "Samples", "Mean", "Time", "Ms/s");
+	printf("| %30s | %10s | %10s | %10s | %10s | %10s |\n", "----------", "----------", "----------", "----------", "----------", "----------");
+
+	std::discrete_distribution<size_t> distribution(weights.begin(), weights.end());
+
+	execute([&](std::mt19937_64& gen) { for (auto& index : samples) index = distribution(gen); }, "discrete_distribution");
+
+	if (max <= 1024)
+	{
+		run_backend(sampling_backend::linear, "linear", 0);
+	}
+	run_backend(sampling_backend::monobound, "monobound", 0);
+	run_backend(sampling_backend::monobound, "monobound batch", 1);
+	run_backend(sampling_backend::alias, "alias", 0);
+	run_backend(sampling_backend::automatic, "automatic batch", 1);
+
+	return 0;
+}